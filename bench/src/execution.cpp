@@ -0,0 +1,87 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <xstd/execution.hpp>            // and_assign, intersection_size, parallel_policy, shared_pool
+#include <algorithm>                     // max, min, nth_element
+#include <chrono>                        // duration, steady_clock
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint64_t
+#include <cstdio>                        // printf
+#include <cstdlib>                       // atoi
+#include <thread>                        // hardware_concurrency, thread
+#include <vector>                        // vector
+
+// The fixed cost of a parallel call, on the shared pool and with a fresh thread per chunk, and
+// the 1 to N thread scaling of a compound assignment and a reduction over sets of growing size.
+// The crossover chunk size is about the fixed cost times the single-threaded bandwidth.
+
+namespace {
+
+template<class Fun>
+auto median_us(int reps, Fun fun)
+{
+        std::vector<double> times;
+        for (auto r = 0; r < reps; ++r) {
+                auto const start = std::chrono::steady_clock::now();
+                fun();
+                times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::nth_element(times.begin(), times.begin() + reps / 2, times.end());
+        return times[static_cast<std::size_t>(reps / 2)];
+}
+
+}       // namespace
+
+// Usage: bench.execution [max_threads], by default std::thread::hardware_concurrency()
+int main(int argc, char* argv[])
+{
+        using namespace xstd;
+        auto const max_threads = argc > 1 ? std::max(std::atoi(argv[1]), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+        std::vector<int> thread_counts;
+        for (auto t = 1; t < max_threads; t *= 2) {
+                thread_counts.push_back(t);
+        }
+        thread_counts.push_back(max_threads);
+
+        std::printf("fixed cost per call (us)\nthreads      pool     spawn\n");
+        for (auto t : thread_counts) {
+                auto noop = [](std::size_t) {};
+                auto const pool = median_us(1001, [&] {
+                        detail::shared_pool().run(static_cast<std::size_t>(t), static_cast<std::size_t>(t), noop);
+                });
+                auto const spawn = median_us(1001, [&] {
+                        std::vector<std::thread> threads;
+                        for (auto i = 1; i < t; ++i) {
+                                threads.emplace_back(noop, std::size_t(0));
+                        }
+                        for (auto& thread : threads) {
+                                thread.join();
+                        }
+                });
+                std::printf("%7d %9.2f %9.2f\n", t, pool, spawn);
+        }
+
+        std::printf("\nbandwidth (GB/s) of and_assign / intersection_size\n   size");
+        for (auto t : thread_counts) {
+                std::printf(" %13d", t);
+        }
+        std::printf("\n");
+        for (auto bytes = std::size_t(1) << 14; bytes <= std::size_t(1) << 26; bytes <<= 2) {
+                auto a = dynamic_bit_set<std::uint64_t>(bytes * 8);
+                auto b = dynamic_bit_set<std::uint64_t>(bytes * 8);
+                a.fill();
+                b.fill();
+                auto const reps = static_cast<int>(std::max(std::size_t(5), (std::size_t(1) << 30) / bytes / 4 + 1));
+                std::printf("%6zuK", bytes >> 10);
+                for (auto t : thread_counts) {
+                        auto const policy = execution::parallel_policy(t);
+                        auto const assign = median_us(reps, [&] { and_assign(policy, a, b); });
+                        auto const reduce = median_us(reps, [&] { static_cast<void>(intersection_size(policy, a, b)); });
+                        std::printf(" %6.1f/%6.1f", 2e-3 * static_cast<double>(bytes) / assign, 2e-3 * static_cast<double>(bytes) / reduce);
+                }
+                std::printf("\n");
+        }
+}
@@ -0,0 +1,139 @@
+#ifndef XSTD_ATOMIC_BIT_SET_HPP
+#define XSTD_ATOMIC_BIT_SET_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <atomic>                        // atomic_ref, memory_order, memory_order_relaxed, memory_order_seq_cst
+#include <cassert>                       // assert
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // size_t
+#include <limits>                        // digits
+#include <utility>                       // pair
+
+namespace xstd {
+
+// A bit_set<N, Block> whose single-element updates may be called concurrently from multiple threads.
+// Each update is one atomic read-modify-write (fetch_or, fetch_and or fetch_xor) through a
+// std::atomic_ref on the block of the element, with a memory order that defaults to seq_cst as
+// for std::atomic. There are no iterators or set algebra: snapshot() copies the blocks into a
+// plain bit_set, which is exact once the writers have been joined and otherwise reflects each
+// block at some point during the copy.
+template<std::size_t N, std::unsigned_integral Block = std::size_t>
+class atomic_bit_set
+{
+        static_assert(N <= std::numeric_limits<int>::max());
+        static_assert(std::atomic_ref<Block>::is_always_lock_free);
+        static_assert(std::atomic_ref<Block>::required_alignment <= alignof(Block));
+
+        static constexpr auto M = static_cast<int>(N);
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto num_blocks = (M - 1 + block_size) / block_size;
+        static constexpr auto last_bit = static_cast<Block>(static_cast<Block>(1) << (block_size - 1));
+
+        using bits_type = bit_set<N, Block>;
+
+        mutable bits_type m_bits;
+public:
+        using key_type               = int;
+        using value_type             = int;
+        using size_type              = std::size_t;
+        using block_type             = Block;
+
+        atomic_bit_set() = default;                     // zero-initialization
+
+        [[nodiscard]] explicit atomic_bit_set(bits_type const& bits) noexcept
+        :
+                m_bits(bits)
+        {}
+
+        // Like std::atomic, an atomic_bit_set is neither copyable nor movable.
+        atomic_bit_set(atomic_bit_set const&) = delete;
+        atomic_bit_set& operator=(atomic_bit_set const&) = delete;
+
+        [[nodiscard]] static constexpr auto max_size() noexcept
+                -> size_type
+        {
+                return N;
+        }
+
+        auto add(value_type x, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+                auto const [ index, mask ] = index_mask(x);
+                ref(index).fetch_or(mask, order);
+        }
+
+        // Returns whether x was newly added, i.e. exactly one of the threads that concurrently
+        // insert x sees true.
+        auto insert(value_type x, std::memory_order order = std::memory_order_seq_cst) noexcept
+                -> bool
+        {
+                auto const [ index, mask ] = index_mask(x);
+                return !(ref(index).fetch_or(mask, order) & mask);
+        }
+
+        auto pop(value_type x, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+                auto const [ index, mask ] = index_mask(x);
+                ref(index).fetch_and(static_cast<Block>(~mask), order);
+        }
+
+        auto erase(value_type x, std::memory_order order = std::memory_order_seq_cst) noexcept
+                -> size_type
+        {
+                auto const [ index, mask ] = index_mask(x);
+                return static_cast<size_type>(static_cast<bool>(ref(index).fetch_and(static_cast<Block>(~mask), order) & mask));
+        }
+
+        auto replace(value_type x, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+                auto const [ index, mask ] = index_mask(x);
+                ref(index).fetch_xor(mask, order);
+        }
+
+        [[nodiscard]] auto contains(value_type x, std::memory_order order = std::memory_order_seq_cst) const noexcept
+                -> bool
+        {
+                auto const [ index, mask ] = index_mask(x);
+                return ref(index).load(order) & mask;
+        }
+
+        // Each block is cleared atomically, but not all blocks at once.
+        auto clear(std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+                for (auto i = 0; i < num_blocks; ++i) {
+                        ref(i).store(0, order);
+                }
+        }
+
+        [[nodiscard]] auto snapshot(std::memory_order order = std::memory_order_relaxed) const noexcept
+                -> bits_type
+        {
+                bits_type nrv;
+                auto const data = detail::bit_set_access::data(nrv);
+                for (auto i = 0; i < num_blocks; ++i) {
+                        data[i] = ref(i).load(order);
+                }
+                return nrv;
+        }
+
+private:
+        [[nodiscard]] static auto index_mask(value_type x) noexcept
+                -> std::pair<int, Block>
+        {
+                assert(0 <= x && x < M);
+                return { num_blocks - 1 - x / block_size, static_cast<Block>(last_bit >> (x % block_size)) };
+        }
+
+        [[nodiscard]] auto ref(int i) const noexcept
+        {
+                return std::atomic_ref<Block>(detail::bit_set_access::data(m_bits)[i]);
+        }
+};
+
+}       // namespace xstd
+
+#endif  // include guard
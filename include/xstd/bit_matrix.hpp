@@ -0,0 +1,198 @@
+#ifndef XSTD_BIT_MATRIX_HPP
+#define XSTD_BIT_MATRIX_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <xstd/detail/block_kernels.hpp> // transpose
+#include <algorithm>                     // min
+#include <array>                         // array
+#include <bit>                           // popcount
+#include <cassert>                       // assert
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // size_t
+#include <limits>                        // digits
+#include <span>                          // span
+
+namespace xstd {
+
+// An R x C matrix of bits, e.g. the adjacency matrix of a graph or a binary relation, stored as
+// R contiguous bit_set<C, Block> rows. Row i contains j if and only if the bit at (i, j) is set.
+// Column queries go through transpose(), which transposes one square tile of Block-sized rows
+// (64 x 64 bits for the default Block) at a time.
+template<std::size_t R, std::size_t C, std::unsigned_integral Block = std::size_t>
+class bit_matrix
+{
+        static_assert(R <= std::numeric_limits<int>::max());
+
+        template<std::size_t, std::size_t, std::unsigned_integral>
+        friend class bit_matrix;
+
+        using access = detail::bit_set_access;
+
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto num_row_blocks = access::num_logical_blocks<bit_set<C, Block>>;
+        static constexpr auto num_column_blocks = access::num_logical_blocks<bit_set<R, Block>>;
+
+        std::array<bit_set<C, Block>, R> m_rows;        // zero-initialization
+public:
+        using row_type       = bit_set<C, Block>;
+        using column_type    = bit_set<R, Block>;
+        using transpose_type = bit_matrix<C, R, Block>;
+        using size_type      = std::size_t;
+        using block_type     = Block;
+
+        bit_matrix() = default;                 // zero-initialization
+
+        bool operator==(bit_matrix const&) const = default;
+
+        [[nodiscard]] static constexpr auto num_rows() noexcept
+        {
+                return R;
+        }
+
+        [[nodiscard]] static constexpr auto num_columns() noexcept
+        {
+                return C;
+        }
+
+        // The rows as a contiguous array, e.g. as the candidates of the one-vs-many queries.
+        [[nodiscard]] constexpr auto rows() noexcept
+        {
+                return std::span<row_type, R>(m_rows);
+        }
+
+        [[nodiscard]] constexpr auto rows() const noexcept
+        {
+                return std::span<row_type const, R>(m_rows);
+        }
+
+        [[nodiscard]] constexpr auto& operator[](int i) noexcept
+        {
+                assert(0 <= i && i < static_cast<int>(R));
+                return m_rows[static_cast<std::size_t>(i)];
+        }
+
+        [[nodiscard]] constexpr auto const& operator[](int i) const noexcept
+        {
+                assert(0 <= i && i < static_cast<int>(R));
+                return m_rows[static_cast<std::size_t>(i)];
+        }
+
+        [[nodiscard]] constexpr auto& row(int i) noexcept
+        {
+                return (*this)[i];
+        }
+
+        [[nodiscard]] constexpr auto const& row(int i) const noexcept
+        {
+                return (*this)[i];
+        }
+
+        // O(R), use transpose() for more than a few columns.
+        [[nodiscard]] constexpr auto column(int j) const noexcept
+        {
+                assert(0 <= j && j < static_cast<int>(C));
+                column_type nrv;
+                for (auto i = 0; i < static_cast<int>(R); ++i) {
+                        if ((*this)[i].contains(j)) {
+                                nrv.add(i);
+                        }
+                }
+                return nrv;
+        }
+
+        [[nodiscard]] constexpr auto contains(int i, int j) const noexcept
+        {
+                return (*this)[i].contains(j);
+        }
+
+        constexpr auto add(int i, int j) noexcept
+        {
+                (*this)[i].add(j);
+        }
+
+        constexpr auto pop(int i, int j) noexcept
+        {
+                (*this)[i].pop(j);
+        }
+
+        constexpr auto clear() noexcept
+        {
+                for (auto& r : m_rows) {
+                        r.clear();
+                }
+        }
+
+        [[nodiscard]] constexpr auto transpose() const noexcept
+        {
+                transpose_type nrv;
+                for_each_transposed_tile([&](int I, int J, Block const* tile) {
+                        for (auto c = 0; c < block_size && J * block_size + c < static_cast<int>(C); ++c) {
+                                access::data(nrv.m_rows[static_cast<std::size_t>(J * block_size + c)])[num_column_blocks - 1 - I] = tile[c];
+                        }
+                });
+                return nrv;
+        }
+
+        // The union of all rows, i.e. the columns with at least one bit set.
+        [[nodiscard]] constexpr auto reduce_or() const noexcept
+        {
+                row_type nrv;
+                for (auto const& r : m_rows) {
+                        nrv |= r;
+                }
+                return nrv;
+        }
+
+        // The intersection of all rows, i.e. the columns with all bits set.
+        [[nodiscard]] constexpr auto reduce_and() const noexcept
+        {
+                row_type nrv;
+                nrv.fill();
+                for (auto const& r : m_rows) {
+                        nrv &= r;
+                }
+                return nrv;
+        }
+
+        // The number of bits set in each column, counted over transposed tiles.
+        [[nodiscard]] constexpr auto column_sizes() const noexcept
+        {
+                std::array<size_type, C> nrv {};
+                for_each_transposed_tile([&](int /* I */, int J, Block const* tile) {
+                        for (auto c = 0; c < block_size && J * block_size + c < static_cast<int>(C); ++c) {
+                                nrv[static_cast<std::size_t>(J * block_size + c)] += static_cast<size_type>(std::popcount(tile[c]));
+                        }
+                });
+                return nrv;
+        }
+
+private:
+        // Calls fun(I, J, tile) for the transpose of each square tile of rows [I * block_size, (I + 1) * block_size)
+        // and columns [J * block_size, (J + 1) * block_size), with the missing rows of the last tile row as zeros.
+        // Tiles are visited one tile row at a time, so that its rows stay in cache across its tiles.
+        template<class TileFunction>
+        constexpr auto for_each_transposed_tile(TileFunction fun) const
+        {
+                for (auto I = 0; I < num_column_blocks; ++I) {
+                        auto const first = I * block_size;
+                        auto const last = std::min(first + block_size, static_cast<int>(R));
+                        for (auto J = 0; J < num_row_blocks; ++J) {
+                                std::array<Block, block_size> tile {};
+                                for (auto r = first; r < last; ++r) {
+                                        tile[static_cast<std::size_t>(r - first)] = access::block(m_rows[static_cast<std::size_t>(r)], num_row_blocks - 1 - J);
+                                }
+                                detail::transpose(tile.data());
+                                fun(I, J, tile.data());
+                        }
+                }
+        }
+};
+
+}       // namespace xstd
+
+#endif  // include guard
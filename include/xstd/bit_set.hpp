@@ -6,25 +6,66 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
-#include <algorithm>            // lexicographical_compare_three_way, max
-#include <bit>                  // countl_zero, countr_zero, has_single_bit, popcount
-#include <cassert>              // assert
-#include <compare>              // strong_ordering
-#include <concepts>             // constructible_from, innput_iteratorl, unsigned_integral
-#include <cstddef>              // ptrdiff_t, size_t
-#include <functional>           // identity, less
-#include <initializer_list>     // initializer_list
-#include <iterator>             // begin, bidirectional_iterator_tag, end, next, prev, rbegin, rend, reverse_iterator
-#include <limits>               // digits
-#include <numeric>              // accumulate
-#include <ranges>               // all_of, copy_backward, copy_n, equal, fill_n, none_of, range, subrange, swap_ranges, views::drop, views::take
-#include <tuple>                // tie
-#include <type_traits>          // common_type_t, conditional_t, is_class_v, make_signed_t
-#include <utility>              // forward, pair, swap
+#include <xstd/detail/block_kernels.hpp> // bit_and, bit_minus, bit_or, bit_xor, count, decode, first_nonzero, format_bits, last_nonzero, load_bytes, parse_bits, popcount, shift_left, shift_right, store_bytes, transform
+#include <xstd/detail/block_storage.hpp> // external_blocks, heap_blocks, inline_blocks
+#include <algorithm>                     // lexicographical_compare_three_way, max, min
+#include <bit>                           // bit_floor, countl_zero, countr_zero, has_single_bit, popcount
+#include <cassert>                       // assert
+#include <compare>                       // strong_ordering
+#include <concepts>                      // constructible_from, derived_from, innput_iteratorl, same_as, unsigned_integral
+#include <cstddef>                       // byte, ptrdiff_t, size_t
+#include <functional>                    // identity, less
+#include <initializer_list>              // initializer_list
+#include <iterator>                      // begin, bidirectional_iterator_tag, forward_iterator_tag, next, rbegin, rend, reverse_iterator
+#include <limits>                        // digits
+#include <memory>                        // allocator
+#include <ranges>                        // all_of, begin, end, equal, fill_n, none_of, range, swap_ranges, views::drop, views::take
+#include <span>                          // span
+#include <stdexcept>                     // invalid_argument, out_of_range
+#include <string>                        // basic_string, char_traits
+#include <string_view>                   // basic_string_view
+#include <tuple>                         // tie
+#include <type_traits>                   // common_type_t, conditional_t, is_class_v, is_nothrow_copy_constructible_v, is_nothrow_default_constructible_v, make_signed_t, remove_const_t
+#include <utility>                       // declval, forward, pair, swap
+#include <vector>                        // vector
 
 namespace xstd {
 
-template<std::size_t N, std::unsigned_integral Block = std::size_t>
+// Storage policies for the blocks of a bit_set: inside the object (the default), in an owned
+// heap allocation so that large sets stay off the stack and move in O(1), or in a fixed buffer
+// owned by the caller.
+
+struct inline_storage
+{
+        template<std::unsigned_integral Block, std::size_t Size>
+        using blocks = detail::inline_blocks<Block, Size>;
+};
+
+struct heap_storage
+{
+        template<std::unsigned_integral Block, std::size_t Size>
+        using blocks = detail::heap_blocks<Block, Size>;
+};
+
+struct external_storage
+{
+        template<std::unsigned_integral Block, std::size_t Size>
+        using blocks = detail::external_blocks<Block, Size>;
+};
+
+template<class Expression, class Set>
+class bit_set_expression;
+
+template<class Set>
+class bit_set_ref;
+
+namespace detail {
+
+struct bit_set_access;
+
+}       // namespace detail
+
+template<std::size_t N, std::unsigned_integral Block = std::size_t, class Storage = inline_storage>
 class bit_set
 {
         static_assert(N <= std::numeric_limits<int>::max());
@@ -44,7 +85,18 @@ class bit_set
         using const_proxy_reference = proxy_reference<true>;
         using const_proxy_iterator = proxy_iterator<true>;
 
-        Block m_data[num_storage_blocks]{};     // zero-initialization
+        using storage_type = typename Storage::template blocks<Block, static_cast<std::size_t>(num_storage_blocks)>;
+
+        storage_type m_data;                    // zero-initialization, except for external_storage
+
+        // Whether writing to the blocks cannot throw. It can for heap_storage, whose moved-from
+        // objects allocate a fresh array on their first write.
+        static constexpr auto nothrow_mutable = noexcept(std::declval<storage_type&>().data());
+
+        friend struct detail::bit_set_access;
+
+        template<std::size_t, std::unsigned_integral, class>
+        friend class bit_set;
 public:
         using key_type               = int;
         using key_compare            = std::less<key_type>;
@@ -64,27 +116,66 @@ public:
 
         bit_set() = default;                    // zero-initialization
 
+        // Adopts the contents of buffer, whose unused bits must be zero, as the blocks of an
+        // external_storage bit_set. The buffer must outlive the bit_set.
+        [[nodiscard]] explicit constexpr bit_set(std::span<Block, static_cast<std::size_t>(num_storage_blocks)> buffer) noexcept
+                requires std::same_as<Storage, external_storage>
+        :
+                m_data(buffer)
+        {
+                if constexpr (has_unused_bits) {
+                        assert(!(m_data[0] & static_cast<block_type>(~used_bits)));
+                }
+        }
+
         template<class InputIterator>
-        [[nodiscard]] constexpr bit_set(InputIterator first, InputIterator last) noexcept
+        [[nodiscard]] constexpr bit_set(InputIterator first, InputIterator last) noexcept(std::is_nothrow_default_constructible_v<storage_type>)
         {
                 insert(first, last);
         }
 
-        [[nodiscard]] constexpr bit_set(std::initializer_list<value_type> ilist) noexcept
+        [[nodiscard]] constexpr bit_set(std::initializer_list<value_type> ilist) noexcept(std::is_nothrow_default_constructible_v<storage_type>)
         :
                 bit_set(ilist.begin(), ilist.end())
         {}
 
-        constexpr auto& operator=(std::initializer_list<value_type> ilist) noexcept
+        constexpr auto& operator=(std::initializer_list<value_type> ilist) noexcept(nothrow_mutable)
         {
                 clear();
                 insert(ilist.begin(), ilist.end());
                 return *this;
         }
 
+        template<class Expression>
+        [[nodiscard]] constexpr bit_set(bit_set_expression<Expression, bit_set> const& expr) noexcept(std::is_nothrow_default_constructible_v<storage_type>)
+        {
+                for (auto i = 0; i < num_logical_blocks; ++i) {
+                        m_data[i] = expr.block(i);
+                }
+        }
+
+        template<class Expression>
+        constexpr auto& operator=(bit_set_expression<Expression, bit_set> const& expr) noexcept(nothrow_mutable)
+        {
+                for (auto i = 0; i < num_logical_blocks; ++i) {
+                        m_data[i] = expr.block(i);
+                }
+                return *this;
+        }
+
         bool operator==(bit_set const&) const = default;
 
-        [[nodiscard]] constexpr auto operator<=>(bit_set const& other [[maybe_unused]]) const noexcept
+        // Sets with a different Storage compare, combine and count as if they had the same one.
+        template<class OtherStorage>
+                requires (!std::same_as<OtherStorage, Storage>)
+        [[nodiscard]] constexpr auto operator==(bit_set<N, Block, OtherStorage> const& other) const noexcept
+                -> bool
+        {
+                return std::ranges::equal(this->m_data, other.m_data);
+        }
+
+        template<class OtherStorage>
+        [[nodiscard]] constexpr auto operator<=>(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) const noexcept
                 -> std::strong_ordering
         {
                 if constexpr (num_logical_blocks == 1) {
@@ -96,8 +187,8 @@ public:
                         return tied(other) <=> tied(*this);
                 } else {
                         return std::lexicographical_compare_three_way(
-                                std::rbegin(other.m_data), std::rend(other.m_data),
-                                std::rbegin(this->m_data), std::rend(this->m_data)
+                                std::ranges::rbegin(other.m_data), std::ranges::rend(other.m_data),
+                                std::ranges::rbegin(this->m_data), std::ranges::rend(this->m_data)
                         );
                 }
         }
@@ -162,10 +253,7 @@ public:
                 } else if constexpr (num_logical_blocks == 2) {
                         return std::popcount(m_data[0]) + std::popcount(m_data[1]);
                 } else {
-                        // C++23: http://open-std.org/JTC1/SC22/WG21/docs/papers/2019/p1813r0.pdf
-                        return std::accumulate(std::begin(m_data), std::end(m_data), 0, [](auto sum, auto block) {
-                                return sum + std::popcount(block);
-                        });
+                        return detail::popcount(m_data.data(), num_logical_blocks);
                 }
         }
 
@@ -185,21 +273,28 @@ public:
                 return num_bits;
         }
 
+        // The number of blocks of the buffer of an external_storage bit_set.
+        [[nodiscard]] static constexpr auto num_blocks() noexcept
+                -> size_type
+        {
+                return num_storage_blocks;
+        }
+
         template<class... Args>
-        constexpr auto emplace(Args&&... args) noexcept
+        constexpr auto emplace(Args&&... args) noexcept(nothrow_mutable)
                 requires (sizeof...(Args) == 1)
         {
                 return insert(value_type(std::forward<Args>(args)...));
         }
 
         template<class... Args>
-        constexpr auto emplace_hint(const_iterator hint, Args&&... args) noexcept
+        constexpr auto emplace_hint(const_iterator hint, Args&&... args) noexcept(nothrow_mutable)
                 requires (sizeof...(Args) == 1)
         {
                 return insert(hint, value_type(std::forward<Args>(args)...));
         }
 
-        constexpr auto add(value_type x) noexcept
+        constexpr auto add(value_type x) noexcept(nothrow_mutable)
         {
                 assert(is_valid(x));
                 auto&& [ block, mask ] = block_mask(x);
@@ -208,7 +303,7 @@ public:
         }
 
 private:
-        constexpr auto do_insert(value_type x) noexcept
+        constexpr auto do_insert(value_type x) noexcept(nothrow_mutable)
                 -> std::pair<iterator, bool>
         {
                 assert(is_valid(x));
@@ -220,18 +315,18 @@ private:
         }
 
 public:
-        constexpr auto insert(value_type const& x) noexcept
+        constexpr auto insert(value_type const& x) noexcept(nothrow_mutable)
         {
                 return do_insert(x);
         }
 
-        constexpr auto insert(value_type&& x) noexcept
+        constexpr auto insert(value_type&& x) noexcept(nothrow_mutable)
         {
                 return do_insert(std::move(x));
         }
 
 private:
-        constexpr auto do_insert(const_iterator /* hint */, value_type x) noexcept
+        constexpr auto do_insert(const_iterator /* hint */, value_type x) noexcept(nothrow_mutable)
                 -> iterator
         {
                 add(x);
@@ -239,51 +334,56 @@ private:
         }
 
 public:
-        constexpr auto insert(const_iterator hint, value_type const& x) noexcept
+        constexpr auto insert(const_iterator hint, value_type const& x) noexcept(nothrow_mutable)
         {
                 return do_insert(hint, x);
         }
 
-        constexpr auto insert(const_iterator hint, value_type&& x) noexcept
+        constexpr auto insert(const_iterator hint, value_type&& x) noexcept(nothrow_mutable)
         {
                 return do_insert(hint, std::move(x));
         }
 
         template<class InputIterator>
-        constexpr auto insert(InputIterator first, InputIterator last) noexcept
+        constexpr auto insert(InputIterator first, InputIterator last) noexcept(nothrow_mutable)
                 requires std::input_iterator<InputIterator> && std::constructible_from<value_type, decltype(*first)>
         {
-                for (auto x : std::ranges::subrange(first, last)) {
-                        add(x);
-                };
+                detail::add_all(m_data.data(), M, first, last);
         }
 
         template<class Range>
-        constexpr auto insert_range(Range&& rg) noexcept
+        constexpr auto insert_range(Range&& rg) noexcept(nothrow_mutable)
                 requires std::ranges::range<Range> && std::constructible_from<value_type, decltype(*rg.begin())>
         {
-                for (auto x : rg) {
-                        add(x);
-                };
+                detail::add_all(m_data.data(), M, std::ranges::begin(rg), std::ranges::end(rg));
         }
 
-        constexpr auto insert(std::initializer_list<value_type> ilist) noexcept
+        constexpr auto insert(std::initializer_list<value_type> ilist) noexcept(nothrow_mutable)
         {
                 insert(ilist.begin(), ilist.end());
         }
 
-        constexpr auto fill() noexcept
+        // Inserts all values in [first, last).
+        constexpr auto insert(value_type first, value_type last) noexcept(nothrow_mutable)
+        {
+                detail::visit_range(m_data.data(), M, first, last, [](auto& block, auto mask) {
+                        block |= mask;
+                        return true;
+                });
+        }
+
+        constexpr auto fill() noexcept(nothrow_mutable)
         {
                 if constexpr (has_unused_bits) {
                         m_data[0] = used_bits;
-                        std::ranges::fill_n(std::next(std::begin(m_data)), num_logical_blocks - 1, ones);
+                        std::ranges::fill_n(std::next(m_data.begin()), num_logical_blocks - 1, ones);
                 } else {
-                        std::ranges::fill_n(std::begin(m_data), num_logical_blocks, ones);
+                        std::ranges::fill_n(m_data.begin(), num_logical_blocks, ones);
                 }
                 assert(full());
         }
 
-        constexpr auto pop(key_type x) noexcept
+        constexpr auto pop(key_type x) noexcept(nothrow_mutable)
         {
                 assert(is_valid(x));
                 auto&& [ block, mask ] = block_mask(x);
@@ -291,7 +391,7 @@ public:
                 assert(!contains(x));
         }
 
-        constexpr auto erase(key_type const& x) noexcept
+        constexpr auto erase(key_type const& x) noexcept(nothrow_mutable)
         {
                 assert(is_valid(x));
                 auto&& [ block, mask ] = block_mask(x);
@@ -301,33 +401,40 @@ public:
                 return erased;
         }
 
-        constexpr auto erase(const_iterator pos) noexcept
+        constexpr auto erase(const_iterator pos) noexcept(nothrow_mutable)
         {
                 assert(pos != end());
                 pop(*pos++);
                 return pos;
         }
 
-        constexpr auto erase(const_iterator first, const_iterator last) noexcept
+        constexpr auto erase(const_iterator first, const_iterator last) noexcept(nothrow_mutable)
         {
-                for (auto x : std::ranges::subrange(first, last)) {
-                        pop(x);
-                }
+                erase(first == cend() ? M : *first, last == cend() ? M : *last);
                 return last;
         }
 
+        // Erases all values in [first, last).
+        constexpr auto erase(value_type first, value_type last) noexcept(nothrow_mutable)
+        {
+                detail::visit_range(m_data.data(), M, first, last, [](auto& block, auto mask) {
+                        block &= static_cast<block_type>(~mask);
+                        return true;
+                });
+        }
+
         constexpr auto swap(bit_set& other [[maybe_unused]]) noexcept
         {
-                std::ranges::swap_ranges(this->m_data, other.m_data);
+                this->m_data.swap(other.m_data);
         }
 
-        constexpr auto clear() noexcept
+        constexpr auto clear() noexcept(nothrow_mutable)
         {
-                std::ranges::fill_n(std::begin(m_data), num_logical_blocks, zero);
+                std::ranges::fill_n(m_data.begin(), num_logical_blocks, zero);
                 assert(empty());
         }
 
-        constexpr auto replace(value_type x [[maybe_unused]]) noexcept
+        constexpr auto replace(value_type x [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 assert(is_valid(x));
                 auto&& [ block, mask ] = block_mask(x);
@@ -361,6 +468,36 @@ public:
                 return block & mask;
         }
 
+        // The number of elements in [first, last).
+        [[nodiscard]] constexpr auto count(value_type first, value_type last) const noexcept
+                -> size_type
+        {
+                auto n = 0;
+                detail::visit_range(m_data.data(), M, first, last, [&](auto block, auto mask) {
+                        n += std::popcount(static_cast<block_type>(block & mask));
+                        return true;
+                });
+                return static_cast<size_type>(n);
+        }
+
+        // Whether any value in [first, last) is an element.
+        [[nodiscard]] constexpr auto contains_any(value_type first, value_type last) const noexcept
+                -> bool
+        {
+                return !detail::visit_range(m_data.data(), M, first, last, [](auto block, auto mask) {
+                        return !(block & mask);
+                });
+        }
+
+        // Whether all values in [first, last) are elements.
+        [[nodiscard]] constexpr auto contains_all(value_type first, value_type last) const noexcept
+                -> bool
+        {
+                return detail::visit_range(m_data.data(), M, first, last, [](auto block, auto mask) {
+                        return (block & mask) == mask;
+                });
+        }
+
         [[nodiscard]] constexpr auto lower_bound(key_type const& x) noexcept
                 -> iterator
         {
@@ -403,7 +540,7 @@ public:
                 return { lower_bound(x), upper_bound(x) };
         }
 
-        constexpr auto& complement() noexcept
+        constexpr auto& complement() noexcept(nothrow_mutable)
         {
                 if constexpr (num_logical_blocks == 1) {
                         m_data[0] = static_cast<block_type>(~m_data[0]);
@@ -419,7 +556,8 @@ public:
                 return *this;
         }
 
-        constexpr auto& operator&=(bit_set const& other [[maybe_unused]]) noexcept
+        template<class OtherStorage>
+        constexpr auto& operator&=(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 if constexpr (num_logical_blocks == 1) {
                         this->m_data[0] &= other.m_data[0];
@@ -427,18 +565,13 @@ public:
                         this->m_data[0] &= other.m_data[0];
                         this->m_data[1] &= other.m_data[1];
                 } else {
-                        // C++23 (currently available in range-v3)
-                        // for (auto&& [lhs, rhs] : ranges::views::zip(this->m_data, other.m_data)) {
-                        //         lhs &= rhs;
-                        // }
-                        for (auto i = 0; i < num_logical_blocks; ++i) {
-                                this->m_data[i] &= other.m_data[i];
-                        }
+                        detail::transform<detail::bit_and>(this->m_data.data(), other.m_data.data(), num_logical_blocks);
                 }
                 return *this;
         }
 
-        constexpr auto& operator|=(bit_set const& other [[maybe_unused]]) noexcept
+        template<class OtherStorage>
+        constexpr auto& operator|=(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 if constexpr (num_logical_blocks == 1) {
                         this->m_data[0] |= other.m_data[0];
@@ -446,18 +579,13 @@ public:
                         this->m_data[0] |= other.m_data[0];
                         this->m_data[1] |= other.m_data[1];
                 } else {
-                        // C++23 (currently available in range-v3)
-                        // for (auto&& [lhs, rhs] : ranges::views::zip(this->m_data, other.m_data)) {
-                        //         lhs |= rhs;
-                        // }
-                        for (auto i = 0; i < num_logical_blocks; ++i) {
-                                this->m_data[i] |= other.m_data[i];
-                        }
+                        detail::transform<detail::bit_or>(this->m_data.data(), other.m_data.data(), num_logical_blocks);
                 }
                 return *this;
         }
 
-        constexpr auto& operator^=(bit_set const& other [[maybe_unused]]) noexcept
+        template<class OtherStorage>
+        constexpr auto& operator^=(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 if constexpr (num_logical_blocks == 1) {
                         this->m_data[0] ^= other.m_data[0];
@@ -465,18 +593,13 @@ public:
                         this->m_data[0] ^= other.m_data[0];
                         this->m_data[1] ^= other.m_data[1];
                 } else {
-                        // C++23 (currently available in range-v3)
-                        // for (auto&& [lhs, rhs] : ranges::views::zip(this->m_data, other.m_data)) {
-                        //         lhs ^= rhs;
-                        // }
-                        for (auto i = 0; i < num_logical_blocks; ++i) {
-                                this->m_data[i] ^= other.m_data[i];
-                        }
+                        detail::transform<detail::bit_xor>(this->m_data.data(), other.m_data.data(), num_logical_blocks);
                 }
                 return *this;
         }
 
-        constexpr auto& operator-=(bit_set const& other [[maybe_unused]]) noexcept
+        template<class OtherStorage>
+        constexpr auto& operator-=(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 if constexpr (num_logical_blocks == 1) {
                         this->m_data[0] &= static_cast<block_type>(~other.m_data[0]);
@@ -484,73 +607,36 @@ public:
                         this->m_data[0] &= static_cast<block_type>(~other.m_data[0]);
                         this->m_data[1] &= static_cast<block_type>(~other.m_data[1]);
                 } else {
-                        // C++23 (currently available in range-v3)
-                        // for (auto&& [lhs, rhs] : ranges::views::zip(this->m_data, other.m_data)) {
-                        //         lhs &= static_cast<block_type>(~rhs);
-                        // }
-                        for (auto i = 0; i < num_logical_blocks; ++i) {
-                                this->m_data[i] &= static_cast<block_type>(~other.m_data[i]);
-                        }
+                        detail::transform<detail::bit_minus>(this->m_data.data(), other.m_data.data(), num_logical_blocks);
                 }
                 return *this;
         }
 
-        constexpr auto& operator<<=(value_type n [[maybe_unused]]) noexcept
+        constexpr auto& operator<<=(value_type n [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 assert(is_valid(n));
                 if constexpr (num_logical_blocks == 1) {
                         m_data[0] >>= n;
                 } else {
-                        if (n == 0) {
-                                return *this;
-                        }
-                        auto const [ n_block, R_shift ] = div(n, block_size);
-                        if (R_shift == 0) {
-                                std::ranges::copy_n(std::next(std::begin(m_data), n_block), num_logical_blocks - n_block, std::begin(m_data));
-                        } else {
-                                auto const L_shift = block_size - R_shift;
-                                for (auto i = 0; i < num_logical_blocks - 1 - n_block; ++i) {
-                                        m_data[i] =
-                                                static_cast<block_type>(m_data[i + n_block    ] >> R_shift) |
-                                                static_cast<block_type>(m_data[i + n_block + 1] << L_shift)
-                                        ;
-                                }
-                                m_data[num_logical_blocks - 1 - n_block] = static_cast<block_type>(m_data[num_logical_blocks - 1] >> R_shift);
-                        }
-                        std::ranges::fill_n(std::prev(std::end(m_data), n_block), n_block, zero);
+                        detail::shift_right(m_data.data(), num_logical_blocks, n);
                 }
                 clear_unused_bits();
                 return *this;
         }
 
-        constexpr auto& operator>>=(value_type n [[maybe_unused]]) noexcept
+        constexpr auto& operator>>=(value_type n [[maybe_unused]]) noexcept(nothrow_mutable)
         {
                 assert(is_valid(n));
                 if constexpr (num_logical_blocks == 1) {
                         m_data[0] <<= n;
                 } else {
-                        if (n == 0) {
-                                return *this;
-                        }
-                        auto const [ n_block, L_shift ] = div(n, block_size);
-                        if (L_shift == 0) {
-                                std::ranges::copy_backward(m_data | std::views::take(num_logical_blocks - n_block), std::end(m_data));
-                        } else {
-                                auto const R_shift = block_size - L_shift;
-                                for (auto i = num_logical_blocks - 1; i > n_block; --i) {
-                                        m_data[i] =
-                                                static_cast<block_type>(m_data[i - n_block    ] << L_shift) |
-                                                static_cast<block_type>(m_data[i - n_block - 1] >> R_shift)
-                                        ;
-                                }
-                                m_data[n_block] = static_cast<block_type>(m_data[0] << L_shift);
-                        }
-                        std::ranges::fill_n(std::begin(m_data), n_block, zero);
+                        detail::shift_left(m_data.data(), num_logical_blocks, n);
                 }
                 return *this;
         }
 
-        [[nodiscard]] constexpr auto is_subset_of(bit_set const& other [[maybe_unused]]) const noexcept
+        template<class OtherStorage>
+        [[nodiscard]] constexpr auto is_subset_of(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) const noexcept
         {
                 // C++23 (currently available in range-v3)
                 // return std::ranges::none_of(ranges::views::zip(this->m_data, other.m_data),
@@ -563,7 +649,8 @@ public:
                 });
         }
 
-        [[nodiscard]] constexpr auto is_proper_subset_of(bit_set const& other [[maybe_unused]]) const noexcept
+        template<class OtherStorage>
+        [[nodiscard]] constexpr auto is_proper_subset_of(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) const noexcept
         {
                 auto i = 0;
                 for (/* init-statement before loop */; i < num_logical_blocks; ++i) {
@@ -589,7 +676,8 @@ public:
                 );
         }
 
-        [[nodiscard]] constexpr auto intersects(bit_set const& other [[maybe_unused]]) const noexcept
+        template<class OtherStorage>
+        [[nodiscard]] constexpr auto intersects(bit_set<N, Block, OtherStorage> const& other [[maybe_unused]]) const noexcept
                 -> bool
         {
                 // C++23 (currently available in range-v3)
@@ -604,6 +692,146 @@ public:
                 });
         }
 
+        // Calls fun(x) for all elements x in ascending order. The bits of the current block stay in
+        // a register and runs of zero blocks are skipped, so this is considerably faster than a loop
+        // over the iterators. For a range-for over a word-caching iterator, use xstd::lazy(*this).
+        template<class UnaryFunction>
+        constexpr auto for_each(UnaryFunction fun) const
+        {
+                for (auto i = detail::last_nonzero(m_data.data(), num_logical_blocks); i >= 0; i = detail::last_nonzero(m_data.data(), i)) {
+                        auto const base = (last_block - i) * block_size;
+                        auto block = m_data[i];
+                        while (block) {
+                                auto const offset = std::countl_zero(block);
+                                fun(base + offset);
+                                block ^= static_cast<block_type>(last_bit >> offset);
+                        }
+                }
+                return fun;
+        }
+
+        // Writes all elements in ascending order to out, which must have room for size() elements,
+        // and returns the number of elements written. This decodes one block at a time and is
+        // considerably faster than a loop over the iterators.
+        constexpr auto decode(std::span<value_type> out [[maybe_unused]]) const noexcept
+                -> size_type
+        {
+                assert(out.size() >= size());
+                return static_cast<size_type>(detail::decode(m_data.data(), num_logical_blocks, out.data()));
+        }
+
+        [[nodiscard]] constexpr auto to_vector() const
+                -> std::vector<value_type>
+        {
+                std::vector<value_type> nrv(size());
+                decode(nrv);
+                return nrv;
+        }
+
+        // The number of bytes of the portable representation of to_bytes and from_bytes.
+        [[nodiscard]] static constexpr auto num_bytes() noexcept
+                -> size_type
+        {
+                return (N + 7) / 8;
+        }
+
+        // Writes the portable representation of the set to out, which must have num_bytes() bytes:
+        // out[i] holds the elements 8 * i to 8 * i + 7, from the most significant bit down, and the
+        // bits past max_size() in the last byte are zero. This is independent of the block type and
+        // the byte order of the machine, and is a single byte reversal on little-endian machines.
+        constexpr auto to_bytes(std::span<std::byte> out) const noexcept
+        {
+                assert(out.size() == num_bytes());
+                detail::store_bytes(m_data.data(), num_logical_blocks, out.data(), num_bytes());
+        }
+
+        [[nodiscard]] constexpr auto to_bytes() const
+                -> std::vector<std::byte>
+        {
+                std::vector<std::byte> nrv(num_bytes());
+                to_bytes(nrv);
+                return nrv;
+        }
+
+        // Replaces the elements by those in the portable representation of to_bytes, which must have
+        // num_bytes() bytes and no bits past max_size().
+        constexpr auto from_bytes(std::span<std::byte const> in) noexcept(nothrow_mutable)
+        {
+                assert(in.size() == num_bytes());
+                detail::load_bytes(in.data(), num_bytes(), m_data.data(), num_logical_blocks);
+                if constexpr (has_unused_bits) {
+                        assert(!(m_data[0] & static_cast<block_type>(~used_bits)));
+                }
+        }
+
+        // Replaces the elements by those in the std::bitset<N> representation of the substring
+        // str[pos, pos + rlen), with rlen = min(n, str.size() - pos). As for std::bitset, only its first
+        // len = min(N, rlen) characters are used: str[pos + len - 1] is element 0 and str[pos] is element
+        // len - 1, so the elements from len on are not in the set, and the rlen - len trailing characters
+        // are only validated. Like the std::bitset constructor, this throws std::out_of_range if
+        // pos > str.size() and std::invalid_argument if any of the rlen characters is neither zero nor
+        // one, in which case the set is left empty. Narrow character strings are parsed 32 or 64
+        // characters at a time.
+        template<class CharT, class Traits>
+        constexpr auto from_string(
+                std::basic_string_view<CharT, Traits> str,
+                typename std::basic_string_view<CharT, Traits>::size_type pos = 0,
+                typename std::basic_string_view<CharT, Traits>::size_type n = std::basic_string_view<CharT, Traits>::npos,
+                CharT zero_char = CharT('0'),
+                CharT one_char = CharT('1')
+        )
+        {
+                if (pos > str.size()) {
+                        throw std::out_of_range("xstd::bit_set::from_string: pos > str.size()");
+                }
+                auto const rlen = std::min(n, str.size() - pos);
+                auto const len = std::min(N, rlen);
+                clear();
+                auto const tail = str.substr(pos + len, rlen - len);
+                if (
+                        detail::parse_bits<CharT, Traits>(str.data() + pos, len, zero_char, one_char, m_data.data(), num_logical_blocks, static_cast<std::size_t>(num_bits) - len) != len ||
+                        !std::ranges::all_of(tail, [=](auto ch) { return Traits::eq(ch, zero_char) || Traits::eq(ch, one_char); })
+                ) {
+                        clear();
+                        throw std::invalid_argument("xstd::bit_set::from_string: character is neither zero nor one");
+                }
+        }
+
+        template<class CharT, class Traits, class Allocator>
+        constexpr auto from_string(
+                std::basic_string<CharT, Traits, Allocator> const& str,
+                typename std::basic_string<CharT, Traits, Allocator>::size_type pos = 0,
+                typename std::basic_string<CharT, Traits, Allocator>::size_type n = std::basic_string<CharT, Traits, Allocator>::npos,
+                CharT zero_char = CharT('0'),
+                CharT one_char = CharT('1')
+        )
+        {
+                from_string(std::basic_string_view<CharT, Traits>(str), pos, n, zero_char, one_char);
+        }
+
+        template<class CharT>
+        constexpr auto from_string(
+                CharT const* str,
+                typename std::basic_string_view<CharT>::size_type n = std::basic_string_view<CharT>::npos,
+                CharT zero_char = CharT('0'),
+                CharT one_char = CharT('1')
+        )
+        {
+                from_string(n == std::basic_string_view<CharT>::npos ? std::basic_string_view<CharT>(str) : std::basic_string_view<CharT>(str, n), 0, n, zero_char, one_char);
+        }
+
+        // The std::bitset<N> representation of the set: character i is one if element N - 1 - i is
+        // in the set and zero otherwise. Narrow character strings are formatted 32 or 64 characters
+        // at a time.
+        template<class CharT = char, class Traits = std::char_traits<CharT>, class Allocator = std::allocator<CharT>>
+        [[nodiscard]] constexpr auto to_string(CharT zero_char = CharT('0'), CharT one_char = CharT('1')) const
+                -> std::basic_string<CharT, Traits, Allocator>
+        {
+                std::basic_string<CharT, Traits, Allocator> nrv(N, zero_char);
+                detail::format_bits<CharT, Traits>(m_data.data(), num_logical_blocks, static_cast<std::size_t>(num_unused_bits), nrv.data(), N, zero_char, one_char);
+                return nrv;
+        }
+
 private:
         static constexpr auto zero = static_cast<block_type>( 0);
         static constexpr auto ones = static_cast<block_type>(-1);
@@ -639,7 +867,7 @@ private:
                 }
         }
 
-        [[nodiscard]] constexpr auto block_mask(value_type n) noexcept
+        [[nodiscard]] constexpr auto block_mask(value_type n) noexcept(nothrow_mutable)
                 -> std::pair<block_type&, block_type>
         {
                 assert(is_valid(n));
@@ -655,7 +883,7 @@ private:
                 return { m_data[last_block - index], static_cast<block_type>(last_bit >> offset) };
         }
 
-        constexpr auto clear_unused_bits() noexcept
+        constexpr auto clear_unused_bits() noexcept(nothrow_mutable)
         {
                 if constexpr (has_unused_bits) {
                         m_data[0] &= used_bits;
@@ -670,13 +898,8 @@ private:
                 } else if constexpr (num_logical_blocks == 2) {
                         return m_data[1] ? std::countl_zero(m_data[1]) : std::countl_zero(m_data[0]) + block_size;
                 } else {
-                        auto n = 0;
-                        for (auto i = num_storage_blocks - 1; i > 0; --i, n += block_size) {
-                                if (auto const block = m_data[i]; block) {
-                                        return n + std::countl_zero(block);
-                                }
-                        }
-                        return n + std::countl_zero(m_data[0]);
+                        auto const i = detail::last_nonzero(m_data.data(), num_logical_blocks);
+                        return (last_block - i) * block_size + std::countl_zero(m_data[i]);
                 }
         }
 
@@ -688,13 +911,8 @@ private:
                 } else if constexpr (num_logical_blocks == 2) {
                         return m_data[0] ? num_bits - 1 - std::countr_zero(m_data[0]) : block_size - 1 - std::countr_zero(m_data[1]);
                 } else {
-                        auto n = num_bits - 1;
-                        for (auto i = 0; i < num_storage_blocks - 1; ++i, n -= block_size) {
-                                if (auto const block = m_data[i]; block) {
-                                        return n - std::countr_zero(block);
-                                }
-                        }
-                        return n - std::countr_zero(m_data[num_storage_blocks - 1]);
+                        auto const i = detail::first_nonzero(m_data.data(), num_logical_blocks);
+                        return num_bits - 1 - i * block_size - std::countr_zero(m_data[i]);
                 }
         }
 
@@ -705,10 +923,8 @@ private:
                                 return std::countl_zero(m_data[0]);
                         }
                 } else {
-                        for (auto i = num_logical_blocks - 1, n = 0; i >= 0; --i, n += block_size) {
-                                if (auto const block = m_data[i]; block) {
-                                        return n + std::countl_zero(block);
-                                }
+                        if (auto const i = detail::last_nonzero(m_data.data(), num_logical_blocks); i >= 0) {
+                                return (last_block - i) * block_size + std::countl_zero(m_data[i]);
                         }
                 }
                 return M;
@@ -734,10 +950,8 @@ private:
                                 --i;
                                 n += block_size - offset;
                         }
-                        for (/* init-statement before loop */; i >= 0; --i, n += block_size) {
-                                if (auto const block = m_data[i]; block) {
-                                        return n + std::countl_zero(block);
-                                }
+                        if (auto const j = detail::last_nonzero(m_data.data(), i + 1); j >= 0) {
+                                return n + (i - j) * block_size + std::countl_zero(m_data[j]);
                         }
                 }
                 return M;
@@ -759,11 +973,9 @@ private:
                                         ++i;
                                         n -= block_size - reverse_offset;
                                 }
-                                for (/* init-statement before loop */; i < num_storage_blocks - 1; ++i, n -= block_size) {
-                                        if (auto const block = m_data[i]; block) {
-                                                return n - std::countr_zero(block);
-                                        }
-                                }
+                                assert(i < num_storage_blocks);
+                                auto const j = i + detail::first_nonzero(m_data.data() + i, num_storage_blocks - 1 - i);
+                                return n - (j - i) * block_size - std::countr_zero(m_data[j]);
                         }
                         return n - std::countr_zero(m_data[num_storage_blocks - 1]);
                 }
@@ -884,145 +1096,544 @@ private:
         };
 };
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator~(bit_set<N, Block> const& lhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator~(bit_set<N, Block, Storage> const& lhs) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv.complement(); return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator&(bit_set<N, Block> const& lhs, bit_set<N, Block> const& rhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator&(bit_set<N, Block, Storage> const& lhs, bit_set<N, Block, Storage> const& rhs) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv &= rhs; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator|(bit_set<N, Block> const& lhs, bit_set<N, Block> const& rhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator|(bit_set<N, Block, Storage> const& lhs, bit_set<N, Block, Storage> const& rhs) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv |= rhs; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator^(bit_set<N, Block> const& lhs, bit_set<N, Block> const& rhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator^(bit_set<N, Block, Storage> const& lhs, bit_set<N, Block, Storage> const& rhs) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv ^= rhs; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator-(bit_set<N, Block> const& lhs, bit_set<N, Block> const& rhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator-(bit_set<N, Block, Storage> const& lhs, bit_set<N, Block, Storage> const& rhs) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv -= rhs; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator<<(bit_set<N, Block> const& lhs, int n) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator<<(bit_set<N, Block, Storage> const& lhs, int n) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv <<= n; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto operator>>(bit_set<N, Block> const& lhs, int n) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto operator>>(bit_set<N, Block, Storage> const& lhs, int n) noexcept(std::is_nothrow_copy_constructible_v<bit_set<N, Block, Storage>>)
 {
         auto nrv = lhs; nrv >>= n; return nrv;
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-constexpr auto swap(bit_set<N, Block>& lhs, bit_set<N, Block>& rhs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+constexpr auto swap(bit_set<N, Block, Storage>& lhs, bit_set<N, Block, Storage>& rhs) noexcept
 {
         lhs.swap(rhs);
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto begin(bit_set<N, Block>& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto begin(bit_set<N, Block, Storage>& bs) noexcept
 {
         return bs.begin();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto begin(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto begin(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.begin();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto end(bit_set<N, Block>& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto end(bit_set<N, Block, Storage>& bs) noexcept
 {
         return bs.end();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto end(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto end(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.end();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto rbegin(bit_set<N, Block>& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto rbegin(bit_set<N, Block, Storage>& bs) noexcept
 {
         return bs.rbegin();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto rbegin(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto rbegin(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.rbegin();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto rend(bit_set<N, Block>& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto rend(bit_set<N, Block, Storage>& bs) noexcept
 {
         return bs.rend();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto rend(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto rend(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.rend();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto cbegin(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto cbegin(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return xstd::begin(bs);
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto cend(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto cend(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return xstd::end(bs);
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto crbegin(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto crbegin(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return xstd::rbegin(bs);
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto crend(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto crend(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return xstd::rend(bs);
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto size(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto size(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.size();
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto ssize(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto ssize(bit_set<N, Block, Storage> const& bs) noexcept
 {
         using R = std::common_type_t<std::ptrdiff_t, std::make_signed_t<decltype(bs.size())>>;
         return static_cast<R>(bs.size());
 }
 
-template<std::size_t N, std::unsigned_integral Block>
-[[nodiscard]] constexpr auto empty(bit_set<N, Block> const& bs) noexcept
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto empty(bit_set<N, Block, Storage> const& bs) noexcept
 {
         return bs.empty();
 }
 
+namespace detail {
+
+struct bit_set_access
+{
+        template<class Set>
+        static constexpr auto num_logical_blocks = Set::num_logical_blocks;
+
+        template<class Set>
+        static constexpr auto block_size = Set::block_size;
+
+        template<class Set>
+        static constexpr auto used_bits = Set::used_bits;
+
+        template<std::size_t N, std::unsigned_integral Block, class Storage>
+        [[nodiscard]] static constexpr auto block(bit_set<N, Block, Storage> const& bs, int i) noexcept
+        {
+                return bs.m_data[i];
+        }
+
+        template<std::size_t N, std::unsigned_integral Block, class Storage>
+        [[nodiscard]] static constexpr auto data(bit_set<N, Block, Storage>& bs) noexcept(noexcept(bs.m_data.data()))
+        {
+                return bs.m_data.data();
+        }
+
+        // The logical blocks, as a span.
+        template<std::size_t N, std::unsigned_integral Block, class Storage>
+        [[nodiscard]] static constexpr auto blocks(bit_set<N, Block, Storage>& bs) noexcept(noexcept(bs.m_data.data()))
+        {
+                return std::span<Block>(bs.m_data.data(), static_cast<std::size_t>(bit_set<N, Block, Storage>::num_logical_blocks));
+        }
+
+        template<std::size_t N, std::unsigned_integral Block, class Storage>
+        [[nodiscard]] static constexpr auto blocks(bit_set<N, Block, Storage> const& bs) noexcept
+        {
+                return std::span<Block const>(bs.m_data.data(), static_cast<std::size_t>(bit_set<N, Block, Storage>::num_logical_blocks));
+        }
+
+        // popcount(Op(lhs, rhs)) in a single pass, without materializing Op(lhs, rhs)
+        template<class Op, std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+        [[nodiscard]] static constexpr auto count(bit_set<N, Block, LhsStorage> const& lhs [[maybe_unused]], bit_set<N, Block, RhsStorage> const& rhs [[maybe_unused]]) noexcept
+                -> int
+        {
+                constexpr auto num_logical_blocks = bit_set<N, Block, LhsStorage>::num_logical_blocks;
+                if constexpr (num_logical_blocks == 1) {
+                        return std::popcount(Op::apply(lhs.m_data[0], rhs.m_data[0]));
+                } else if constexpr (num_logical_blocks == 2) {
+                        return
+                                std::popcount(Op::apply(lhs.m_data[0], rhs.m_data[0])) +
+                                std::popcount(Op::apply(lhs.m_data[1], rhs.m_data[1]))
+                        ;
+                } else {
+                        return detail::count<Op>(lhs.m_data.data(), rhs.m_data.data(), num_logical_blocks);
+                }
+        }
+};
+
+}       // namespace detail
+
+template<std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+[[nodiscard]] constexpr auto intersection_size(bit_set<N, Block, LhsStorage> const& lhs, bit_set<N, Block, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::bit_set_access::count<detail::bit_and>(lhs, rhs));
+}
+
+template<std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+[[nodiscard]] constexpr auto union_size(bit_set<N, Block, LhsStorage> const& lhs, bit_set<N, Block, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::bit_set_access::count<detail::bit_or>(lhs, rhs));
+}
+
+template<std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+[[nodiscard]] constexpr auto difference_size(bit_set<N, Block, LhsStorage> const& lhs, bit_set<N, Block, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::bit_set_access::count<detail::bit_minus>(lhs, rhs));
+}
+
+template<std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+[[nodiscard]] constexpr auto symmetric_difference_size(bit_set<N, Block, LhsStorage> const& lhs, bit_set<N, Block, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::bit_set_access::count<detail::bit_xor>(lhs, rhs));
+}
+
+// Jaccard (or Tanimoto) similarity |lhs & rhs| / |lhs | rhs|, defined as 1 for two empty sets.
+template<std::size_t N, std::unsigned_integral Block, class LhsStorage, class RhsStorage>
+[[nodiscard]] constexpr auto jaccard_index(bit_set<N, Block, LhsStorage> const& lhs, bit_set<N, Block, RhsStorage> const& rhs) noexcept
+        -> double
+{
+        auto const num_union = union_size(lhs, rhs);
+        return num_union ? static_cast<double>(intersection_size(lhs, rhs)) / static_cast<double>(num_union) : 1.0;
+}
+
+// A lazy tree of &, |, ^, - and ~ over bit_set operands, evaluated in a single blockwise pass
+// when it is assigned to a bit_set, compared, counted or iterated. Operands are held by reference,
+// so an expression must not outlive the sets it was built from. Start a tree with xstd::lazy().
+template<class Expression, class Set>
+class bit_set_expression
+{
+        using access = detail::bit_set_access;
+        static constexpr auto num_logical_blocks = access::num_logical_blocks<Set>;
+        static constexpr auto block_size = access::block_size<Set>;
+        static constexpr auto used_bits = access::used_bits<Set>;
+        static constexpr auto last_block = num_logical_blocks - 1;
+
+        class const_iterator;
+public:
+        using set_type   = Set;
+        using block_type = typename Set::block_type;
+        using value_type = typename Set::value_type;
+        using size_type  = typename Set::size_type;
+        using iterator   = const_iterator;
+
+        // The unused bits of block 0 can only be set by ~ and no operator moves bits across
+        // blocks, so masking them once at the root is enough for any tree.
+        [[nodiscard]] constexpr auto block(int i) const noexcept
+                -> block_type
+        {
+                auto const b = static_cast<Expression const&>(*this).eval(i);
+                return i == 0 ? static_cast<block_type>(b & used_bits) : b;
+        }
+
+        template<class Other>
+        [[nodiscard]] constexpr auto operator==(bit_set_expression<Other, Set> const& other) const noexcept
+                -> bool
+        {
+                for (auto i = 0; i < num_logical_blocks; ++i) {
+                        if (this->block(i) != other.block(i)) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+        [[nodiscard]] constexpr auto operator==(Set const& other) const noexcept
+                -> bool
+        {
+                return *this == bit_set_ref<Set>(other);
+        }
+
+        template<class Other>
+        [[nodiscard]] constexpr auto operator<=>(bit_set_expression<Other, Set> const& other) const noexcept
+                -> std::strong_ordering
+        {
+                for (auto i = last_block; i >= 0; --i) {
+                        if (auto const lhs = this->block(i), rhs = other.block(i); lhs != rhs) {
+                                return rhs <=> lhs;
+                        }
+                }
+                return std::strong_ordering::equal;
+        }
+
+        [[nodiscard]] constexpr auto operator<=>(Set const& other) const noexcept
+                -> std::strong_ordering
+        {
+                return *this <=> bit_set_ref<Set>(other);
+        }
+
+        [[nodiscard]] constexpr auto begin() const noexcept { return const_iterator(this); }
+        [[nodiscard]] constexpr auto end()   const noexcept { return const_iterator(); }
+
+        [[nodiscard]] constexpr auto empty() const noexcept
+        {
+                for (auto i = 0; i < num_logical_blocks; ++i) {
+                        if (block(i)) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+        [[nodiscard]] constexpr auto ssize() const noexcept
+        {
+                auto n = 0;
+                if constexpr (num_logical_blocks <= 2) {
+                        for (auto i = 0; i < num_logical_blocks; ++i) {
+                                n += std::popcount(block(i));
+                        }
+                } else {
+                        // Evaluate into a chunk that stays in L1 and count it with the vectorized popcount.
+                        constexpr auto chunk_size = std::min(num_logical_blocks, static_cast<int>(1024 / sizeof(block_type)));
+                        block_type chunk[chunk_size]{};
+                        for (auto i = 0; i < num_logical_blocks; i += chunk_size) {
+                                auto const m = std::min(chunk_size, num_logical_blocks - i);
+                                for (auto j = 0; j < m; ++j) {
+                                        chunk[j] = block(i + j);
+                                }
+                                n += detail::popcount(chunk, m);
+                        }
+                }
+                return n;
+        }
+
+        [[nodiscard]] constexpr auto size() const noexcept
+        {
+                return static_cast<size_type>(ssize());
+        }
+
+private:
+        // Caches the remaining bits of the current block, so that each block of the
+        // expression is evaluated once per traversal.
+        class const_iterator
+        {
+        public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type   = std::ptrdiff_t;
+                using value_type        = bit_set_expression::value_type;
+                using pointer           = void;
+                using reference         = value_type;
+
+        private:
+                bit_set_expression const* m_ptr = nullptr;
+                int m_index = -1;
+                block_type m_block = 0;
+
+                constexpr auto skip_zero_blocks() noexcept
+                {
+                        while (!m_block && --m_index >= 0) {
+                                m_block = m_ptr->block(m_index);
+                        }
+                }
+
+        public:
+                const_iterator() = default;
+
+                [[nodiscard]] explicit constexpr const_iterator(bit_set_expression const* p) noexcept
+                :
+                        m_ptr(p),
+                        m_index(num_logical_blocks)
+                {
+                        skip_zero_blocks();
+                }
+
+                [[nodiscard]] constexpr auto operator==(const_iterator const& other) const noexcept
+                        -> bool
+                {
+                        return this->m_index == other.m_index && this->m_block == other.m_block;
+                }
+
+                [[nodiscard]] constexpr auto operator*() const noexcept
+                        -> value_type
+                {
+                        assert(m_block);
+                        return (last_block - m_index) * block_size + std::countl_zero(m_block);
+                }
+
+                constexpr auto& operator++() noexcept
+                {
+                        assert(m_block);
+                        m_block ^= std::bit_floor(m_block);
+                        skip_zero_blocks();
+                        return *this;
+                }
+
+                constexpr auto operator++(int) noexcept
+                {
+                        auto nrv = *this; ++*this; return nrv;
+                }
+        };
+};
+
+template<class Set>
+class bit_set_ref
+:
+        public bit_set_expression<bit_set_ref<Set>, Set>
+{
+        Set const* m_ptr;
+public:
+        [[nodiscard]] explicit constexpr bit_set_ref(Set const& bs) noexcept
+        :
+                m_ptr(&bs)
+        {}
+
+        [[nodiscard]] constexpr auto eval(int i) const noexcept
+        {
+                return detail::bit_set_access::block(*m_ptr, i);
+        }
+};
+
+template<class Op, class Lhs, class Rhs>
+class bit_set_binary_expression
+:
+        public bit_set_expression<bit_set_binary_expression<Op, Lhs, Rhs>, typename Lhs::set_type>
+{
+        Lhs m_lhs;
+        Rhs m_rhs;
+public:
+        [[nodiscard]] constexpr bit_set_binary_expression(Lhs const& lhs, Rhs const& rhs) noexcept
+        :
+                m_lhs(lhs),
+                m_rhs(rhs)
+        {}
+
+        [[nodiscard]] constexpr auto eval(int i) const noexcept
+        {
+                return Op::apply(m_lhs.eval(i), m_rhs.eval(i));
+        }
+};
+
+template<class Arg>
+class bit_set_complement_expression
+:
+        public bit_set_expression<bit_set_complement_expression<Arg>, typename Arg::set_type>
+{
+        Arg m_arg;
+public:
+        [[nodiscard]] explicit constexpr bit_set_complement_expression(Arg const& arg) noexcept
+        :
+                m_arg(arg)
+        {}
+
+        [[nodiscard]] constexpr auto eval(int i) const noexcept
+        {
+                return static_cast<typename Arg::block_type>(~m_arg.eval(i));
+        }
+};
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] constexpr auto lazy(bit_set<N, Block, Storage> const& bs) noexcept
+{
+        return bit_set_ref<bit_set<N, Block, Storage>>(bs);
+}
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+auto lazy(bit_set<N, Block, Storage> const&&) = delete;
+
+namespace detail {
+
+template<class T>
+inline constexpr auto is_bit_set = false;
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+inline constexpr auto is_bit_set<bit_set<N, Block, Storage>> = true;
+
+template<class T>
+concept set_expression = requires { typename T::set_type; } && std::derived_from<T, bit_set_expression<T, typename T::set_type>>;
+
+// At least one side must already be an expression: bit_set op bit_set stays eager.
+template<class Lhs, class Rhs>
+concept lazy_operands =
+        (set_expression<Lhs> && set_expression<Rhs> && std::same_as<typename Lhs::set_type, typename Rhs::set_type>) ||
+        (set_expression<Lhs> && std::same_as<typename Lhs::set_type, Rhs>) ||
+        (set_expression<Rhs> && std::same_as<typename Rhs::set_type, Lhs>)
+;
+
+template<class T>
+[[nodiscard]] constexpr auto as_expression(T const& t) noexcept
+{
+        if constexpr (is_bit_set<T>) {
+                return bit_set_ref<T>(t);
+        } else {
+                return t;
+        }
+}
+
+template<class Op, class Lhs, class Rhs>
+[[nodiscard]] constexpr auto make_binary_expression(Lhs const& lhs, Rhs const& rhs) noexcept
+{
+        auto const l = as_expression(lhs);
+        auto const r = as_expression(rhs);
+        return bit_set_binary_expression<Op, std::remove_const_t<decltype(l)>, std::remove_const_t<decltype(r)>>(l, r);
+}
+
+}       // namespace detail
+
+template<class Arg>
+[[nodiscard]] constexpr auto operator~(Arg const& arg) noexcept
+        requires detail::set_expression<Arg>
+{
+        return bit_set_complement_expression<Arg>(arg);
+}
+
+template<class Lhs, class Rhs>
+[[nodiscard]] constexpr auto operator&(Lhs const& lhs, Rhs const& rhs) noexcept
+        requires detail::lazy_operands<Lhs, Rhs>
+{
+        return detail::make_binary_expression<detail::bit_and>(lhs, rhs);
+}
+
+template<class Lhs, class Rhs>
+[[nodiscard]] constexpr auto operator|(Lhs const& lhs, Rhs const& rhs) noexcept
+        requires detail::lazy_operands<Lhs, Rhs>
+{
+        return detail::make_binary_expression<detail::bit_or>(lhs, rhs);
+}
+
+template<class Lhs, class Rhs>
+[[nodiscard]] constexpr auto operator^(Lhs const& lhs, Rhs const& rhs) noexcept
+        requires detail::lazy_operands<Lhs, Rhs>
+{
+        return detail::make_binary_expression<detail::bit_xor>(lhs, rhs);
+}
+
+template<class Lhs, class Rhs>
+[[nodiscard]] constexpr auto operator-(Lhs const& lhs, Rhs const& rhs) noexcept
+        requires detail::lazy_operands<Lhs, Rhs>
+{
+        return detail::make_binary_expression<detail::bit_minus>(lhs, rhs);
+}
+
 }       // namespace xstd
 
 #endif  // include guard
@@ -0,0 +1,75 @@
+#ifndef XSTD_BIT_SET_BATCH_HPP
+#define XSTD_BIT_SET_BATCH_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <xstd/detail/block_kernels.hpp> // batch_any, batch_count, bit_and, bit_minus
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set, dynamic_bit_set_access
+#include <algorithm>                     // reverse
+#include <cassert>                       // assert
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // size_t
+#include <span>                          // span
+#include <type_traits>                   // type_identity_t
+
+// One-vs-many queries of a single bit_set against a contiguous array of candidates, as in
+// matching a query against a database of stored sets. The query is loaded into registers once
+// and the candidates are streamed through it, rather than reloading both for every member call.
+// The predicates write their results into a dynamic_bit_set of candidates.size() elements that
+// contains j if and only if the predicate holds for candidates[j]; the counts go into an array.
+
+namespace xstd {
+namespace detail {
+
+template<class Op, std::size_t N, std::unsigned_integral Block, std::unsigned_integral OutBlock, class Allocator, class Storage>
+auto batch_predicate(bit_set<N, Block> const& query, std::span<bit_set<N, Block> const> candidates, dynamic_bit_set<OutBlock, Allocator, Storage>& out) noexcept
+{
+        constexpr auto n = bit_set_access::num_logical_blocks<bit_set<N, Block>>;
+        auto const words = dynamic_bit_set_access::blocks(out);
+        detail::batch_any<Op, n>(
+                bit_set_access::blocks(query).data(),
+                reinterpret_cast<unsigned char const*>(candidates.data()), sizeof(bit_set<N, Block>), candidates.size(),
+                words.data()
+        );
+        std::ranges::reverse(words);
+}
+
+}       // namespace detail
+
+// out contains j if and only if query.intersects(candidates[j]).
+template<std::size_t N, std::unsigned_integral Block, std::unsigned_integral OutBlock, class Allocator, class Storage>
+auto intersects(bit_set<N, Block> const& query, std::type_identity_t<std::span<bit_set<N, Block> const>> candidates, dynamic_bit_set<OutBlock, Allocator, Storage>& out) noexcept
+{
+        assert(out.max_size() == candidates.size());
+        detail::batch_predicate<detail::bit_and>(query, candidates, out);
+}
+
+// out contains j if and only if query.is_subset_of(candidates[j]).
+template<std::size_t N, std::unsigned_integral Block, std::unsigned_integral OutBlock, class Allocator, class Storage>
+auto is_subset_of(bit_set<N, Block> const& query, std::type_identity_t<std::span<bit_set<N, Block> const>> candidates, dynamic_bit_set<OutBlock, Allocator, Storage>& out) noexcept
+{
+        assert(out.max_size() == candidates.size());
+        detail::batch_predicate<detail::bit_minus>(query, candidates, out);
+        out.complement();
+}
+
+// out[j] = intersection_size(query, candidates[j]).
+template<std::size_t N, std::unsigned_integral Block>
+auto intersection_size(bit_set<N, Block> const& query, std::type_identity_t<std::span<bit_set<N, Block> const>> candidates, std::span<std::size_t> out) noexcept
+{
+        assert(out.size() == candidates.size());
+        constexpr auto n = detail::bit_set_access::num_logical_blocks<bit_set<N, Block>>;
+        detail::batch_count<detail::bit_and, n>(
+                detail::bit_set_access::blocks(query).data(),
+                reinterpret_cast<unsigned char const*>(candidates.data()), sizeof(bit_set<N, Block>), candidates.size(),
+                out.data()
+        );
+}
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -0,0 +1,389 @@
+#ifndef XSTD_BIT_SET_FILE_HPP
+#define XSTD_BIT_SET_FILE_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set
+#include <xstd/bit_span.hpp>             // bit_span
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <algorithm>                     // min, none_of
+#include <bit>                           // endian
+#include <cassert>                       // assert
+#include <cerrno>                        // errno
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // byte, size_t
+#include <cstdint>                       // uint8_t, uint32_t, uint64_t
+#include <cstring>                       // memcmp, memcpy
+#include <filesystem>                    // path
+#include <fstream>                       // ofstream
+#include <ios>                           // ios_base
+#include <limits>                        // digits, max
+#include <span>                          // dynamic_extent, span
+#include <stdexcept>                     // runtime_error
+#include <string>                        // string
+#include <system_error>                  // generic_category, system_error
+#include <utility>                       // exchange, move
+#include <vector>                        // vector
+
+#if __has_include(<sys/mman.h>)
+        #define XSTD_BIT_SET_FILE_MMAP 1
+        #include <fcntl.h>               // O_RDONLY, open
+        #include <sys/mman.h>            // MAP_FAILED, MAP_SHARED, PROT_READ, mmap, munmap
+        #include <sys/stat.h>            // fstat, stat
+        #include <unistd.h>              // close
+#else
+        #define XSTD_BIT_SET_FILE_MMAP 0
+#endif
+
+// A versioned binary file format for bit sets, which is loaded by mapping it into memory.
+//
+// The file starts with a 64-byte detail::bit_set_file_header, followed by the num_blocks(n)
+// blocks of a set with max_size() == n, exactly as they are laid out in memory by bit_set and
+// dynamic_bit_set: the value x is the bit (block_size - 1 - x % block_size) of the block with
+// index (num_blocks(n) - 1 - x / block_size). The header fields and the blocks are stored in
+// the byte order of the machine that wrote the file, which is recorded in the header, and a
+// file can only be loaded on a machine with the same byte order and block width.
+//
+// mapped_bit_set requires a POSIX system, and is only defined if XSTD_BIT_SET_FILE_MMAP is 1.
+// It reports I/O errors and invalid files by throwing std::system_error and std::runtime_error,
+// respectively. bit_set_writer and save() are portable, and report I/O errors by throwing
+// std::ios_base::failure.
+
+namespace xstd {
+
+namespace detail {
+
+struct bit_set_file_header
+{
+        static constexpr char          bits_magic[8] = { 'X', 'S', 'T', 'D', 'B', 'I', 'T', 'S' };
+        static constexpr std::uint32_t bits_version = 1;
+        static constexpr std::uint8_t  reversed_blocks = 1;  // the layout described above
+
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t block_size;       // bits per block
+        std::uint64_t size;             // max_size()
+        std::uint8_t  endian;           // 0 for little-endian, 1 for big-endian
+        std::uint8_t  bit_order;
+        std::uint8_t  reserved[38];
+};
+
+static_assert(sizeof(bit_set_file_header) == 64);
+
+[[nodiscard]] inline auto native_endian() noexcept
+        -> std::uint8_t
+{
+        static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big);
+        return std::endian::native == std::endian::little ? 0 : 1;
+}
+
+template<std::unsigned_integral Block>
+[[nodiscard]] auto make_file_header(std::size_t n) noexcept
+{
+        bit_set_file_header header{};
+        std::memcpy(header.magic, bit_set_file_header::bits_magic, sizeof(header.magic));
+        header.version = bit_set_file_header::bits_version;
+        header.block_size = static_cast<std::uint32_t>(std::numeric_limits<Block>::digits);
+        header.size = n;
+        header.endian = native_endian();
+        header.bit_order = bit_set_file_header::reversed_blocks;
+        return header;
+}
+
+#if XSTD_BIT_SET_FILE_MMAP
+
+// A read-only shared mapping of a whole file, unmapped on destruction.
+class file_mapping
+{
+        void* m_addr = nullptr;
+        std::size_t m_length = 0;
+public:
+        [[nodiscard]] explicit file_mapping(std::filesystem::path const& path)
+        {
+                auto const fd = ::open(path.c_str(), O_RDONLY);
+                if (fd == -1) {
+                        throw std::system_error(errno, std::generic_category(), "xstd::mapped_bit_set: open " + path.string());
+                }
+                struct stat st;
+                if (::fstat(fd, &st) == -1) {
+                        auto const error = errno;
+                        ::close(fd);
+                        throw std::system_error(error, std::generic_category(), "xstd::mapped_bit_set: fstat " + path.string());
+                }
+                m_length = static_cast<std::size_t>(st.st_size);
+                if (m_length < sizeof(bit_set_file_header)) {
+                        ::close(fd);
+                        throw std::runtime_error("xstd::mapped_bit_set: " + path.string() + " is too short for a header");
+                }
+                m_addr = ::mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+                auto const error = errno;
+                ::close(fd);            // the mapping keeps the file open
+                if (m_addr == MAP_FAILED) {
+                        throw std::system_error(error, std::generic_category(), "xstd::mapped_bit_set: mmap " + path.string());
+                }
+        }
+
+        [[nodiscard]] file_mapping(file_mapping&& other) noexcept
+        :
+                m_addr(std::exchange(other.m_addr, nullptr)),
+                m_length(std::exchange(other.m_length, 0))
+        {}
+
+        file_mapping(file_mapping const&) = delete;
+        file_mapping& operator=(file_mapping const&) = delete;
+
+        ~file_mapping()
+        {
+                if (m_addr) {
+                        ::munmap(m_addr, m_length);
+                }
+        }
+
+        [[nodiscard]] auto data() const noexcept
+        {
+                return static_cast<std::byte const*>(m_addr);
+        }
+
+        [[nodiscard]] auto size() const noexcept
+        {
+                return m_length;
+        }
+};
+
+#endif
+
+}       // namespace detail
+
+#if XSTD_BIT_SET_FILE_MMAP
+
+// A bit set loaded in O(1) from a file in the above format, by mapping it read-only into memory.
+// Pages are read from the file on first access, and are shared with every other process that
+// maps the same file. The set is exposed as a const bit_span, which is valid for the lifetime of
+// the mapped_bit_set.
+template<std::unsigned_integral Block = std::size_t>
+class mapped_bit_set
+{
+        using span_type = bit_span<std::dynamic_extent, Block>;
+
+        detail::file_mapping m_mapping;
+        span_type m_set;
+
+        // The bits of the first block that do not correspond to a value less than n.
+        [[nodiscard]] static auto unused_bits(std::size_t n) noexcept
+        {
+                auto const num_unused = span_type::num_blocks(n) * static_cast<std::size_t>(std::numeric_limits<Block>::digits) - n;
+                return static_cast<Block>(~static_cast<Block>(static_cast<Block>(-1) << num_unused));
+        }
+
+        [[nodiscard]] static auto checked_size(detail::file_mapping const& mapping)
+                -> std::size_t
+        {
+                detail::bit_set_file_header header;
+                std::memcpy(&header, mapping.data(), sizeof(header));
+                auto const fail = [](char const* what) {
+                        throw std::runtime_error(std::string("xstd::mapped_bit_set: ") + what);
+                };
+                if (std::memcmp(header.magic, detail::bit_set_file_header::bits_magic, sizeof(header.magic))) {
+                        fail("not a bit set file");
+                }
+                if (header.endian != detail::native_endian()) {
+                        fail("the file has a different byte order");
+                }
+                if (header.version != detail::bit_set_file_header::bits_version) {
+                        fail("unsupported version");
+                }
+                if (header.bit_order != detail::bit_set_file_header::reversed_blocks) {
+                        fail("unsupported bit order");
+                }
+                if (header.block_size != static_cast<std::uint32_t>(std::numeric_limits<Block>::digits)) {
+                        fail("the file has a different block width");
+                }
+                if (header.size > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+                        fail("the file is too large for a bit set");
+                }
+                auto const n = static_cast<std::size_t>(header.size);
+                auto const num_blocks = span_type::num_blocks(n);
+                if (mapping.size() < sizeof(header) + num_blocks * sizeof(Block)) {
+                        fail("the file is truncated");
+                }
+                if (num_blocks > 0) {
+                        Block first;
+                        std::memcpy(&first, mapping.data() + sizeof(header), sizeof(first));
+                        if (first & unused_bits(n)) {
+                                fail("the file has values beyond its size");
+                        }
+                }
+                return n;
+        }
+
+        [[nodiscard]] static auto blocks(detail::file_mapping const& mapping, std::size_t n) noexcept
+        {
+                // the mapping is never written to, the const_cast only serves to construct a bit_span
+                auto const first = const_cast<std::byte*>(mapping.data() + sizeof(detail::bit_set_file_header));
+                return std::span<Block>(reinterpret_cast<Block*>(first), span_type::num_blocks(n));
+        }
+
+        [[nodiscard]] explicit mapped_bit_set(detail::file_mapping&& mapping)
+        :
+                mapped_bit_set(std::move(mapping), checked_size(mapping))
+        {}
+
+        [[nodiscard]] mapped_bit_set(detail::file_mapping&& mapping, std::size_t n) noexcept
+        :
+                m_mapping(std::move(mapping)),
+                m_set(n, blocks(m_mapping, n))
+        {}
+
+public:
+        [[nodiscard]] explicit mapped_bit_set(std::filesystem::path const& path)
+        :
+                mapped_bit_set(detail::file_mapping(path))
+        {}
+
+        [[nodiscard]] auto const& get() const noexcept
+        {
+                return m_set;
+        }
+
+        [[nodiscard]] auto const& operator*() const noexcept
+        {
+                return m_set;
+        }
+
+        [[nodiscard]] auto operator->() const noexcept
+        {
+                return &m_set;
+        }
+};
+
+#endif
+
+// Writes a set with max_size() == n to a file in the above format, from its values or blocks in
+// increasing order, while holding at most window_size blocks in memory. Ranges of blocks that
+// are never written stay zero, and only the non-zero windows of blocks are written.
+template<std::unsigned_integral Block = std::size_t>
+class bit_set_writer
+{
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto last_bit = static_cast<Block>(static_cast<Block>(1) << (block_size - 1));
+        static constexpr auto window_size = 4096;
+
+        std::ofstream m_file;
+        int m_size;
+        int m_num_blocks;
+        int m_first = 0;                        // the index of the first block in the window
+        std::vector<Block> m_window;            // in the reverse order of the indices, as in the file
+
+        [[nodiscard]] auto offset(int index) const noexcept
+        {
+                return static_cast<std::streamoff>(sizeof(detail::bit_set_file_header)) + static_cast<std::streamoff>(m_num_blocks - 1 - index) * static_cast<std::streamoff>(sizeof(Block));
+        }
+
+        auto flush()
+        {
+                if (std::ranges::none_of(m_window, [](auto block) { return block != 0; })) {
+                        return;
+                }
+                m_file.seekp(offset(m_first + static_cast<int>(m_window.size()) - 1));
+                m_file.write(reinterpret_cast<char const*>(m_window.data()), static_cast<std::streamsize>(m_window.size() * sizeof(Block)));
+        }
+
+        // The block with the given index, after moving the window forward if needed.
+        [[nodiscard]] auto block(int index)
+                -> Block&
+        {
+                assert(m_first <= index && index < m_num_blocks);
+                if (index >= m_first + static_cast<int>(m_window.size())) {
+                        flush();
+                        m_first = index;
+                        m_window.assign(static_cast<std::size_t>(std::min(window_size, m_num_blocks - index)), Block(0));
+                }
+                return m_window[static_cast<std::size_t>(m_first + static_cast<int>(m_window.size()) - 1 - index)];
+        }
+
+public:
+        using value_type = int;
+        using size_type  = std::size_t;
+        using block_type = Block;
+
+        [[nodiscard]] bit_set_writer(std::filesystem::path const& path, size_type n)
+        :
+                m_size(static_cast<int>(n)),
+                m_num_blocks(static_cast<int>(dynamic_bit_set<Block>::num_blocks(n)))
+        {
+                assert(n <= static_cast<size_type>(std::numeric_limits<int>::max()));
+                m_file.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+                m_file.open(path, std::ios_base::binary | std::ios_base::trunc);
+                auto const header = detail::make_file_header<Block>(n);
+                m_file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+                if (m_num_blocks > 0) {
+                        // extend the file with zero blocks
+                        m_file.seekp(offset(0) + static_cast<std::streamoff>(sizeof(Block)) - 1);
+                        m_file.put('\0');
+                }
+        }
+
+        bit_set_writer(bit_set_writer const&) = delete;
+        bit_set_writer& operator=(bit_set_writer const&) = delete;
+
+        // Writes the pending blocks, but cannot report errors. Call close() to do so.
+        ~bit_set_writer()
+        {
+                if (m_file.is_open()) {
+                        m_file.exceptions(std::ios_base::goodbit);
+                        flush();
+                }
+        }
+
+        // Adds x, which must not be less than any value or block written so far.
+        auto insert(value_type x)
+        {
+                assert(0 <= x && x < m_size);
+                block(x / block_size) |= static_cast<Block>(last_bit >> (x % block_size));
+        }
+
+        // Adds the values in the block with the given index, i.e. the values index * block_size + i
+        // for every bit (block_size - 1 - i) of b, where the index must not be less than that of
+        // any value or block written so far.
+        auto insert_block(int index, Block b)
+        {
+                assert(index < m_num_blocks - 1 || !(b & static_cast<Block>(~static_cast<Block>(static_cast<Block>(-1) << (m_num_blocks * block_size - m_size)))));
+                block(index) |= b;
+        }
+
+        auto close()
+        {
+                flush();
+                m_window.clear();
+                m_file.close();
+        }
+};
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+auto save(std::filesystem::path const& path, bit_set<N, Block, Storage> const& bs)
+{
+        constexpr auto num_blocks = detail::bit_set_access::num_logical_blocks<bit_set<N, Block, Storage>>;
+        auto writer = bit_set_writer<Block>(path, N);
+        for (auto i = 0; i < num_blocks; ++i) {
+                writer.insert_block(i, detail::bit_set_access::block(bs, num_blocks - 1 - i));
+        }
+        writer.close();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+auto save(std::filesystem::path const& path, dynamic_bit_set<Block, Allocator, Storage> const& bs)
+{
+        auto const num_blocks = static_cast<int>(bs.num_blocks(bs.max_size()));
+        auto writer = bit_set_writer<Block>(path, bs.max_size());
+        for (auto i = 0; i < num_blocks; ++i) {
+                writer.insert_block(i, detail::dynamic_bit_set_access::block(bs, num_blocks - 1 - i));
+        }
+        writer.close();
+}
+
+}       // namespace xstd
+
+#endif  // include guard
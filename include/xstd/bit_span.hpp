@@ -0,0 +1,47 @@
+#ifndef XSTD_BIT_SPAN_HPP
+#define XSTD_BIT_SPAN_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, external_storage
+#include <xstd/detail/block_storage.hpp> // external_blocks
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // size_t
+#include <memory>                        // allocator
+#include <span>                          // dynamic_extent
+
+namespace xstd {
+
+namespace detail {
+
+template<std::size_t N, std::unsigned_integral Block>
+struct bit_span
+{
+        using type = bit_set<N, Block, external_storage>;
+};
+
+template<std::unsigned_integral Block>
+struct bit_span<std::dynamic_extent, Block>
+{
+        using type = dynamic_bit_set<Block, std::allocator<Block>, external_blocks<Block, std::dynamic_extent>>;
+};
+
+}       // namespace detail
+
+// A non-owning view of a caller-owned buffer of blocks as an ordered set of int, in the same bit
+// layout as xstd::bit_set<N, Block>. A fixed extent N is a bit_set over a buffer of exactly
+// bit_set<N, Block>::num_blocks() blocks, constructed as bit_span<N, Block>(buffer). The dynamic
+// extent is a dynamic_bit_set over the first dynamic_bit_set<Block>::num_blocks(n) blocks of a
+// buffer, constructed as bit_span<std::dynamic_extent, Block>(n, buffer). Either one has the full
+// read and compound assignment interface of its owning counterpart, without ever allocating, and
+// combines with owning sets of the same extent and block type in both directions.
+template<std::size_t N, std::unsigned_integral Block = std::size_t>
+using bit_span = typename detail::bit_span<N, Block>::type;
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -0,0 +1,1313 @@
+#ifndef XSTD_COMPRESSED_BIT_SET_HPP
+#define XSTD_COMPRESSED_BIT_SET_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, difference_size
+#include <xstd/detail/block_kernels.hpp> // bit_and, bit_minus, bit_or, bit_xor
+#include <algorithm>                     // binary_search, lexicographical_compare_three_way, lower_bound, max, min, upper_bound
+#include <cassert>                       // assert
+#include <compare>                       // strong_ordering
+#include <concepts>                      // constructible_from, input_iterator, same_as
+#include <cstddef>                       // ptrdiff_t, size_t
+#include <cstdint>                       // uint16_t, uint32_t, uint64_t
+#include <functional>                    // less
+#include <initializer_list>              // initializer_list
+#include <iterator>                      // back_inserter, bidirectional_iterator_tag, next, prev, reverse_iterator
+#include <memory>                        // make_unique, unique_ptr
+#include <ranges>                        // begin, end, equal, range, set_difference, set_intersection, set_symmetric_difference, set_union
+#include <utility>                       // move, pair, swap
+#include <variant>                       // get, get_if, variant, visit
+#include <vector>                        // vector
+
+namespace xstd {
+
+namespace detail::roaring {
+
+inline constexpr auto chunk_bits = 16;
+inline constexpr auto chunk_size = 1 << chunk_bits;             // values per chunk
+inline constexpr auto chunk_bytes = chunk_size / 8;             // bytes of a bitmap chunk
+inline constexpr auto max_array_size = chunk_bytes / 2;         // the largest array chunk that is not larger than a bitmap
+
+using array_chunk = std::vector<std::uint16_t>;                 // sorted values
+
+using bitmap_type = bit_set<chunk_size, std::uint64_t>;
+
+// A heap-allocated bitmap with a cached cardinality, so that sparse chunks do not pay for its 8 KiB.
+class bitmap_chunk
+{
+        std::unique_ptr<bitmap_type> m_bits = std::make_unique<bitmap_type>();
+        int m_size = 0;
+public:
+        bitmap_chunk() = default;
+
+        [[nodiscard]] bitmap_chunk(bitmap_chunk const& other)
+        :
+                m_bits(std::make_unique<bitmap_type>(*other.m_bits)),
+                m_size(other.m_size)
+        {}
+
+        bitmap_chunk(bitmap_chunk&&) = default;
+
+        auto& operator=(bitmap_chunk const& other)
+        {
+                m_bits = std::make_unique<bitmap_type>(*other.m_bits);
+                m_size = other.m_size;
+                return *this;
+        }
+
+        bitmap_chunk& operator=(bitmap_chunk&&) = default;
+
+        [[nodiscard]] auto operator==(bitmap_chunk const& other) const noexcept
+                -> bool
+        {
+                return *this->m_bits == *other.m_bits;
+        }
+
+        [[nodiscard]] auto const& bits() const noexcept
+        {
+                return *m_bits;
+        }
+
+        [[nodiscard]] auto size() const noexcept
+        {
+                return m_size;
+        }
+
+        auto insert(int x) noexcept
+        {
+                auto const inserted = m_bits->insert(x).second;
+                m_size += inserted;
+                return inserted;
+        }
+
+        auto erase(int x) noexcept
+        {
+                auto const erased = m_bits->erase(x) != 0;
+                m_size -= erased;
+                return erased;
+        }
+
+        // Calls fun(bits) and recounts the cardinality.
+        template<class Fun>
+        auto modify(Fun fun)
+        {
+                fun(*m_bits);
+                m_size = m_bits->ssize();
+        }
+};
+
+// The closed interval [first, last] of values.
+struct run
+{
+        std::uint16_t first;
+        std::uint16_t last;
+
+        bool operator==(run const&) const = default;
+};
+
+using run_chunk = std::vector<run>;                             // sorted, disjoint and non-adjacent runs
+
+using chunk = std::variant<array_chunk, bitmap_chunk, run_chunk>;
+
+[[nodiscard]] inline auto cardinality(array_chunk const& a) noexcept
+{
+        return static_cast<int>(a.size());
+}
+
+[[nodiscard]] inline auto cardinality(bitmap_chunk const& b) noexcept
+{
+        return b.size();
+}
+
+[[nodiscard]] inline auto cardinality(run_chunk const& r) noexcept
+{
+        auto n = 0;
+        for (auto [ first, last ] : r) {
+                n += last - first + 1;
+        }
+        return n;
+}
+
+[[nodiscard]] inline auto cardinality(chunk const& c) noexcept
+{
+        return std::visit([](auto const& x) { return cardinality(x); }, c);
+}
+
+[[nodiscard]] inline auto is_empty(chunk const& c) noexcept
+{
+        if (auto const b = std::get_if<bitmap_chunk>(&c)) {
+                return b->size() == 0;
+        }
+        return std::visit([](auto const& x) { return cardinality(x) == 0; }, c);
+}
+
+// The number of maximal runs of consecutive values.
+[[nodiscard]] inline auto num_runs(array_chunk const& a) noexcept
+{
+        auto n = 0;
+        for (auto i = std::size_t(0); i < a.size(); ++i) {
+                n += i == 0 || a[i] != a[i - 1] + 1;
+        }
+        return n;
+}
+
+[[nodiscard]] inline auto num_runs(bitmap_chunk const& b) noexcept
+{
+        // the values x with x - 1 not in the chunk
+        return static_cast<int>(difference_size(b.bits(), b.bits() << 1));
+}
+
+[[nodiscard]] inline auto num_runs(run_chunk const& r) noexcept
+{
+        return static_cast<int>(r.size());
+}
+
+[[nodiscard]] inline auto contains(array_chunk const& a, int x) noexcept
+{
+        return std::binary_search(a.begin(), a.end(), x);
+}
+
+[[nodiscard]] inline auto contains(bitmap_chunk const& b, int x) noexcept
+{
+        return b.bits().contains(x);
+}
+
+[[nodiscard]] inline auto contains(run_chunk const& r, int x) noexcept
+{
+        auto const it = std::upper_bound(r.begin(), r.end(), x, [](int v, run const& y) {
+                return v < y.first;
+        });
+        return it != r.begin() && x <= std::prev(it)->last;
+}
+
+// The smallest value not less than 0 <= x <= chunk_size, or chunk_size if there is none.
+[[nodiscard]] inline auto next(array_chunk const& a, int x) noexcept
+{
+        auto const it = std::lower_bound(a.begin(), a.end(), x);
+        return it == a.end() ? chunk_size : static_cast<int>(*it);
+}
+
+[[nodiscard]] inline auto next(bitmap_chunk const& b, int x) noexcept
+{
+        if (x == chunk_size) {
+                return chunk_size;
+        }
+        auto const it = b.bits().lower_bound(x);
+        return it == b.bits().end() ? chunk_size : static_cast<int>(*it);
+}
+
+[[nodiscard]] inline auto next(run_chunk const& r, int x) noexcept
+{
+        auto const it = std::lower_bound(r.begin(), r.end(), x, [](run const& y, int v) {
+                return y.last < v;
+        });
+        return it == r.end() ? chunk_size : std::max(static_cast<int>(it->first), x);
+}
+
+// The largest value less than 0 <= x <= chunk_size, or -1 if there is none.
+[[nodiscard]] inline auto prev(array_chunk const& a, int x) noexcept
+{
+        auto const it = std::lower_bound(a.begin(), a.end(), x);
+        return it == a.begin() ? -1 : static_cast<int>(*std::prev(it));
+}
+
+[[nodiscard]] inline auto prev(bitmap_chunk const& b, int x) noexcept
+{
+        auto const& bits = b.bits();
+        auto const it = x == chunk_size ? bits.end() : bits.lower_bound(x);
+        return it == bits.begin() ? -1 : static_cast<int>(*std::prev(it));
+}
+
+[[nodiscard]] inline auto prev(run_chunk const& r, int x) noexcept
+{
+        auto const it = std::lower_bound(r.begin(), r.end(), x, [](run const& y, int v) {
+                return y.first < v;
+        });
+        return it == r.begin() ? -1 : std::min(static_cast<int>(std::prev(it)->last), x - 1);
+}
+
+[[nodiscard]] inline auto next(chunk const& c, int x) noexcept
+{
+        return std::visit([=](auto const& y) { return next(y, x); }, c);
+}
+
+[[nodiscard]] inline auto prev(chunk const& c, int x) noexcept
+{
+        return std::visit([=](auto const& y) { return prev(y, x); }, c);
+}
+
+template<class UnaryFunction>
+auto for_each(array_chunk const& a, UnaryFunction&& fun)
+{
+        for (auto x : a) {
+                fun(static_cast<int>(x));
+        }
+}
+
+template<class UnaryFunction>
+auto for_each(bitmap_chunk const& b, UnaryFunction&& fun)
+{
+        b.bits().for_each([&](int x) {
+                fun(x);
+        });
+}
+
+template<class UnaryFunction>
+auto for_each(run_chunk const& r, UnaryFunction&& fun)
+{
+        for (auto [ first, last ] : r) {
+                for (int x = first; x <= last; ++x) {
+                        fun(x);
+                }
+        }
+}
+
+template<class Chunk>
+[[nodiscard]] auto make_array(Chunk const& c)
+        -> array_chunk
+{
+        array_chunk nrv;
+        nrv.reserve(static_cast<std::size_t>(cardinality(c)));
+        for_each(c, [&](int x) {
+                nrv.push_back(static_cast<std::uint16_t>(x));
+        });
+        return nrv;
+}
+
+template<class Chunk>
+[[nodiscard]] auto make_bitmap(Chunk const& c)
+        -> bitmap_chunk
+{
+        if constexpr (std::same_as<Chunk, bitmap_chunk>) {
+                return c;
+        } else {
+                bitmap_chunk nrv;
+                nrv.modify([&](auto& bits) {
+                        if constexpr (std::same_as<Chunk, array_chunk>) {
+                                bits.insert(c.begin(), c.end());
+                        } else {
+                                for (auto [ first, last ] : c) {
+                                        bits.insert(first, last + 1);
+                                }
+                        }
+                });
+                return nrv;
+        }
+}
+
+template<class Chunk>
+[[nodiscard]] auto make_runs(Chunk const& c)
+        -> run_chunk
+{
+        run_chunk nrv;
+        for_each(c, [&](int x) {
+                if (!nrv.empty() && nrv.back().last + 1 == x) {
+                        nrv.back().last = static_cast<std::uint16_t>(x);
+                } else {
+                        nrv.push_back({ static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(x) });
+                }
+        });
+        return nrv;
+}
+
+// Re-picks the smallest of the three representations: 2 bytes per value for an array
+// of at most max_array_size values, chunk_bytes for a bitmap, or 4 bytes per run.
+inline auto normalize(chunk& c)
+{
+        auto const [ n, r ] = std::visit([](auto const& x) {
+                return std::pair(cardinality(x), num_runs(x));
+        }, c);
+        auto const dense_bytes = n <= max_array_size ? 2 * n : chunk_bytes;
+        if (4 * r < dense_bytes) {
+                if (!std::holds_alternative<run_chunk>(c)) {
+                        c = std::visit([](auto const& x) { return make_runs(x); }, c);
+                }
+        } else if (n <= max_array_size) {
+                if (!std::holds_alternative<array_chunk>(c)) {
+                        c = std::visit([](auto const& x) { return make_array(x); }, c);
+                }
+        } else {
+                if (!std::holds_alternative<bitmap_chunk>(c)) {
+                        c = std::visit([](auto const& x) { return make_bitmap(x); }, c);
+                }
+        }
+}
+
+// A run chunk with more than this many runs is never the smallest representation.
+inline constexpr auto max_num_runs = chunk_bytes / 4;
+
+// Inserts x and returns whether it was not yet present. An array converts to a bitmap when it
+// exceeds max_array_size values, a run chunk is re-picked when it exceeds max_num_runs runs.
+inline auto insert(chunk& c, int x)
+        -> bool
+{
+        if (auto const a = std::get_if<array_chunk>(&c)) {
+                auto const it = std::lower_bound(a->begin(), a->end(), x);
+                if (it != a->end() && *it == x) {
+                        return false;
+                }
+                a->insert(it, static_cast<std::uint16_t>(x));
+                if (cardinality(*a) > max_array_size) {
+                        c = make_bitmap(*a);
+                }
+                return true;
+        }
+        if (auto const b = std::get_if<bitmap_chunk>(&c)) {
+                return b->insert(x);
+        }
+        auto& r = std::get<run_chunk>(c);
+        auto const it = std::upper_bound(r.begin(), r.end(), x, [](int v, run const& y) {
+                return v < y.first;
+        });
+        if (it != r.begin() && x <= std::prev(it)->last) {
+                return false;
+        }
+        auto const join_prev = it != r.begin() && std::prev(it)->last + 1 == x;
+        auto const join_next = it != r.end() && it->first == x + 1;
+        if (join_prev && join_next) {
+                std::prev(it)->last = it->last;
+                r.erase(it);
+        } else if (join_prev) {
+                std::prev(it)->last = static_cast<std::uint16_t>(x);
+        } else if (join_next) {
+                it->first = static_cast<std::uint16_t>(x);
+        } else {
+                r.insert(it, { static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(x) });
+                if (num_runs(r) > max_num_runs) {
+                        normalize(c);
+                }
+        }
+        return true;
+}
+
+// Erases x and returns whether it was present. A bitmap converts to an array when it
+// drops to max_array_size values, a run chunk is re-picked when it exceeds max_num_runs runs.
+inline auto erase(chunk& c, int x)
+        -> bool
+{
+        if (auto const a = std::get_if<array_chunk>(&c)) {
+                auto const it = std::lower_bound(a->begin(), a->end(), x);
+                if (it == a->end() || *it != x) {
+                        return false;
+                }
+                a->erase(it);
+                return true;
+        }
+        if (auto const b = std::get_if<bitmap_chunk>(&c)) {
+                if (!b->erase(x)) {
+                        return false;
+                }
+                if (b->size() <= max_array_size) {
+                        c = make_array(*b);
+                }
+                return true;
+        }
+        auto& r = std::get<run_chunk>(c);
+        auto const it = std::upper_bound(r.begin(), r.end(), x, [](int v, run const& y) {
+                return v < y.first;
+        });
+        if (it == r.begin() || x > std::prev(it)->last) {
+                return false;
+        }
+        auto const p = std::prev(it);
+        if (p->first == p->last) {
+                r.erase(p);
+        } else if (x == p->first) {
+                p->first = static_cast<std::uint16_t>(x + 1);
+        } else if (x == p->last) {
+                p->last = static_cast<std::uint16_t>(x - 1);
+        } else {
+                auto const last = p->last;
+                p->last = static_cast<std::uint16_t>(x - 1);
+                r.insert(it, { static_cast<std::uint16_t>(x + 1), last });
+                if (num_runs(r) > max_num_runs) {
+                        normalize(c);
+                }
+        }
+        return true;
+}
+
+template<class Op>
+inline constexpr auto is_op = std::same_as<Op, bit_and> || std::same_as<Op, bit_or> || std::same_as<Op, bit_xor> || std::same_as<Op, bit_minus>;
+
+template<class Op>
+auto assign(bitmap_type& lhs, bitmap_type const& rhs) noexcept
+{
+        if constexpr (std::same_as<Op, bit_and>) {
+                lhs &= rhs;
+        } else if constexpr (std::same_as<Op, bit_or>) {
+                lhs |= rhs;
+        } else if constexpr (std::same_as<Op, bit_xor>) {
+                lhs ^= rhs;
+        } else {
+                lhs -= rhs;
+        }
+}
+
+// Op(lhs, rhs) over the runs of both chunks, by sweeping over the boundaries of all runs
+// and emitting the intervals on which Op holds.
+template<class Op>
+[[nodiscard]] auto sweep(run_chunk const& lhs, run_chunk const& rhs)
+        -> run_chunk
+{
+        run_chunk nrv;
+        auto i = lhs.begin();
+        auto j = rhs.begin();
+        for (auto x = 0; x < chunk_size; /* increment inside loop */) {
+                auto const in_lhs = i != lhs.end() && i->first <= x;
+                auto const in_rhs = j != rhs.end() && j->first <= x;
+                auto const next_lhs = in_lhs ? i->last + 1 : (i != lhs.end() ? static_cast<int>(i->first) : chunk_size);
+                auto const next_rhs = in_rhs ? j->last + 1 : (j != rhs.end() ? static_cast<int>(j->first) : chunk_size);
+                auto const y = std::min(next_lhs, next_rhs);
+                if (Op::apply(static_cast<std::uint8_t>(in_lhs), static_cast<std::uint8_t>(in_rhs))) {
+                        if (!nrv.empty() && nrv.back().last + 1 == x) {
+                                nrv.back().last = static_cast<std::uint16_t>(y - 1);
+                        } else {
+                                nrv.push_back({ static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y - 1) });
+                        }
+                }
+                x = y;
+                if (in_lhs && x == i->last + 1) {
+                        ++i;
+                }
+                if (in_rhs && x == j->last + 1) {
+                        ++j;
+                }
+        }
+        return nrv;
+}
+
+// Op(lhs, rhs) for each of the nine pairs of representations, without re-picking the representation.
+
+template<class Op> auto evaluate(array_chunk  const& lhs, array_chunk  const& rhs) -> chunk;
+template<class Op> auto evaluate(array_chunk  const& lhs, bitmap_chunk const& rhs) -> chunk;
+template<class Op> auto evaluate(array_chunk  const& lhs, run_chunk    const& rhs) -> chunk;
+template<class Op> auto evaluate(bitmap_chunk const& lhs, array_chunk  const& rhs) -> chunk;
+template<class Op> auto evaluate(bitmap_chunk const& lhs, bitmap_chunk const& rhs) -> chunk;
+template<class Op> auto evaluate(bitmap_chunk const& lhs, run_chunk    const& rhs) -> chunk;
+template<class Op> auto evaluate(run_chunk    const& lhs, array_chunk  const& rhs) -> chunk;
+template<class Op> auto evaluate(run_chunk    const& lhs, bitmap_chunk const& rhs) -> chunk;
+template<class Op> auto evaluate(run_chunk    const& lhs, run_chunk    const& rhs) -> chunk;
+
+template<class Op>
+auto evaluate(array_chunk const& lhs, array_chunk const& rhs)
+        -> chunk
+{
+        array_chunk nrv;
+        if constexpr (std::same_as<Op, bit_and>) {
+                std::ranges::set_intersection(lhs, rhs, std::back_inserter(nrv));
+        } else if constexpr (std::same_as<Op, bit_or>) {
+                std::ranges::set_union(lhs, rhs, std::back_inserter(nrv));
+        } else if constexpr (std::same_as<Op, bit_xor>) {
+                std::ranges::set_symmetric_difference(lhs, rhs, std::back_inserter(nrv));
+        } else {
+                std::ranges::set_difference(lhs, rhs, std::back_inserter(nrv));
+        }
+        return nrv;
+}
+
+template<class Op>
+auto evaluate(array_chunk const& lhs, bitmap_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_and> || std::same_as<Op, bit_minus>) {
+                array_chunk nrv;
+                for (auto x : lhs) {
+                        if (rhs.bits().contains(x) == std::same_as<Op, bit_and>) {
+                                nrv.push_back(x);
+                        }
+                }
+                return nrv;
+        } else {
+                auto nrv = rhs;
+                nrv.modify([&](auto& bits) {
+                        for (auto x : lhs) {
+                                if constexpr (std::same_as<Op, bit_or>) {
+                                        bits.add(x);
+                                } else {
+                                        bits.replace(x);
+                                }
+                        }
+                });
+                return nrv;
+        }
+}
+
+template<class Op>
+auto evaluate(array_chunk const& lhs, run_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_and> || std::same_as<Op, bit_minus>) {
+                array_chunk nrv;
+                auto it = rhs.begin();
+                for (auto x : lhs) {
+                        while (it != rhs.end() && it->last < x) {
+                                ++it;
+                        }
+                        if ((it != rhs.end() && it->first <= x) == std::same_as<Op, bit_and>) {
+                                nrv.push_back(x);
+                        }
+                }
+                return nrv;
+        } else {
+                return sweep<Op>(make_runs(lhs), rhs);
+        }
+}
+
+template<class Op>
+auto evaluate(bitmap_chunk const& lhs, array_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_minus>) {
+                auto nrv = lhs;
+                nrv.modify([&](auto& bits) {
+                        for (auto x : rhs) {
+                                bits.pop(x);
+                        }
+                });
+                return nrv;
+        } else {
+                return evaluate<Op>(rhs, lhs);
+        }
+}
+
+template<class Op>
+auto evaluate(bitmap_chunk const& lhs, bitmap_chunk const& rhs)
+        -> chunk
+{
+        auto nrv = lhs;
+        nrv.modify([&](auto& bits) {
+                assign<Op>(bits, rhs.bits());
+        });
+        return nrv;
+}
+
+template<class Op>
+auto evaluate(bitmap_chunk const& lhs, run_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_xor>) {
+                return evaluate<Op>(rhs, lhs);
+        } else {
+                auto nrv = lhs;
+                nrv.modify([&](auto& bits) {
+                        if constexpr (std::same_as<Op, bit_and>) {
+                                auto first = 0;
+                                for (auto [ lo, hi ] : rhs) {
+                                        bits.erase(first, static_cast<int>(lo));
+                                        first = hi + 1;
+                                }
+                                bits.erase(first, chunk_size);
+                        } else if constexpr (std::same_as<Op, bit_or>) {
+                                for (auto [ lo, hi ] : rhs) {
+                                        bits.insert(static_cast<int>(lo), hi + 1);
+                                }
+                        } else {
+                                for (auto [ lo, hi ] : rhs) {
+                                        bits.erase(static_cast<int>(lo), hi + 1);
+                                }
+                        }
+                });
+                return nrv;
+        }
+}
+
+template<class Op>
+auto evaluate(run_chunk const& lhs, array_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_minus>) {
+                return sweep<Op>(lhs, make_runs(rhs));
+        } else {
+                return evaluate<Op>(rhs, lhs);
+        }
+}
+
+template<class Op>
+auto evaluate(run_chunk const& lhs, bitmap_chunk const& rhs)
+        -> chunk
+{
+        if constexpr (std::same_as<Op, bit_and> || std::same_as<Op, bit_or>) {
+                return evaluate<Op>(rhs, lhs);
+        } else {
+                auto nrv = make_bitmap(lhs);
+                nrv.modify([&](auto& bits) {
+                        assign<Op>(bits, rhs.bits());
+                });
+                return nrv;
+        }
+}
+
+template<class Op>
+auto evaluate(run_chunk const& lhs, run_chunk const& rhs)
+        -> chunk
+{
+        return sweep<Op>(lhs, rhs);
+}
+
+template<class Op>
+[[nodiscard]] auto evaluate(chunk const& lhs, chunk const& rhs)
+        -> chunk
+        requires is_op<Op>
+{
+        return std::visit([](auto const& x, auto const& y) {
+                return evaluate<Op>(x, y);
+        }, lhs, rhs);
+}
+
+template<class Op>
+[[nodiscard]] auto combine(chunk const& lhs, chunk const& rhs)
+        -> chunk
+{
+        auto nrv = evaluate<Op>(lhs, rhs);
+        normalize(nrv);
+        return nrv;
+}
+
+// Array and run chunks are unique for a given set of values, and a chunk with more
+// than max_array_size values is never an array, so only mixed pairs need a real comparison.
+[[nodiscard]] inline auto equal(chunk const& lhs, chunk const& rhs)
+        -> bool
+{
+        if (lhs.index() == rhs.index()) {
+                return lhs == rhs;
+        }
+        return cardinality(lhs) == cardinality(rhs) && is_empty(evaluate<bit_xor>(lhs, rhs));
+}
+
+}       // namespace detail::roaring
+
+namespace detail {
+
+struct compressed_bit_set_access;
+
+}       // namespace detail
+
+// An ordered set of std::uint32_t over the full 32-bit universe, compressed as in Roaring bitmaps
+// (Chambi, Lemire et al.). Values are grouped by their upper 16 bits into chunks of 65536 values.
+// A chunk stores its lower 16 bits as a sorted array, as a bit_set<65536> bitmap or as a list of
+// runs, whichever is smallest. The set operators combine chunks pairwise with a dedicated algorithm
+// for each pair of representations, and re-pick the representation of the chunks they produce.
+// Single-element updates only convert a chunk when its representation outgrows the others.
+class compressed_bit_set
+{
+        using chunk = detail::roaring::chunk;
+
+        std::vector<std::uint16_t> m_keys;      // sorted upper 16 bits of the non-empty chunks
+        std::vector<chunk> m_chunks;
+
+        friend struct detail::compressed_bit_set_access;
+
+public:
+        class const_iterator;
+
+        using key_type               = std::uint32_t;
+        using key_compare            = std::less<key_type>;
+        using value_type             = std::uint32_t;
+        using value_compare          = std::less<value_type>;
+        using pointer                = void;
+        using const_pointer          = void;
+        using reference              = value_type;
+        using const_reference        = value_type;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using iterator               = const_iterator;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+        [[nodiscard]] static constexpr auto key(value_type x) noexcept
+        {
+                return static_cast<std::uint16_t>(x >> detail::roaring::chunk_bits);
+        }
+
+        [[nodiscard]] static constexpr auto low(value_type x) noexcept
+        {
+                return static_cast<int>(x & (detail::roaring::chunk_size - 1));
+        }
+
+        [[nodiscard]] static constexpr auto index(int i) noexcept
+        {
+                return static_cast<std::size_t>(i);
+        }
+
+        [[nodiscard]] auto num_chunks() const noexcept
+        {
+                return static_cast<int>(m_keys.size());
+        }
+
+        // The index of the first chunk whose key is not less than k.
+        [[nodiscard]] auto chunk_index(std::uint16_t k) const noexcept
+        {
+                return static_cast<int>(std::lower_bound(m_keys.begin(), m_keys.end(), k) - m_keys.begin());
+        }
+
+        [[nodiscard]] auto first_in(int i) const noexcept
+                -> const_iterator
+        {
+                return i == num_chunks() ? const_iterator(this, i, 0) : const_iterator(this, i, detail::roaring::next(m_chunks[index(i)], 0));
+        }
+
+        auto erase_chunk(int i)
+        {
+                m_keys.erase(m_keys.begin() + i);
+                m_chunks.erase(m_chunks.begin() + i);
+        }
+
+        template<class Iterator, class Sentinel>
+        auto add_all(Iterator first, Sentinel last)
+        {
+                while (first != last) {
+                        auto const x = static_cast<value_type>(*first);
+                        ++first;
+                        auto const k = key(x);
+                        auto i = chunk_index(k);
+                        if (i == num_chunks() || m_keys[index(i)] != k) {
+                                m_keys.insert(m_keys.begin() + i, k);
+                                m_chunks.insert(m_chunks.begin() + i, detail::roaring::array_chunk());
+                        }
+                        auto& c = m_chunks[index(i)];
+                        detail::roaring::insert(c, low(x));
+                        for (/* init-statement before loop */; first != last; ++first) {
+                                auto const y = static_cast<value_type>(*first);
+                                if (key(y) != k) {
+                                        break;
+                                }
+                                detail::roaring::insert(c, low(y));
+                        }
+                        detail::roaring::normalize(c);
+                }
+        }
+
+        // Erases all values in [first, last), with whole chunks dropped and partial chunks
+        // combined with a single run.
+        auto erase_values(std::uint64_t first, std::uint64_t last)
+        {
+                constexpr auto chunk_size = static_cast<std::uint64_t>(detail::roaring::chunk_size);
+                for (auto i = chunk_index(key(static_cast<value_type>(first))); i < num_chunks(); /* increment inside loop */) {
+                        auto const base = static_cast<std::uint64_t>(m_keys[index(i)]) * chunk_size;
+                        if (base >= last) {
+                                break;
+                        }
+                        auto const lo = std::max(first, base) - base;
+                        auto const hi = std::min(last, base + chunk_size) - base;
+                        if (lo == 0 && hi == chunk_size) {
+                                erase_chunk(i);
+                                continue;
+                        }
+                        auto const interval = detail::roaring::run_chunk{ { static_cast<std::uint16_t>(lo), static_cast<std::uint16_t>(hi - 1) } };
+                        m_chunks[index(i)] = detail::roaring::combine<detail::bit_minus>(m_chunks[index(i)], interval);
+                        if (detail::roaring::is_empty(m_chunks[index(i)])) {
+                                erase_chunk(i);
+                        } else {
+                                ++i;
+                        }
+                }
+        }
+
+        // Merges the sorted chunk keys of both sets and combines the chunks present in both.
+        template<class Op>
+        auto& merge(compressed_bit_set const& other)
+        {
+                constexpr auto keep_lhs = !std::same_as<Op, detail::bit_and>;
+                constexpr auto keep_rhs = std::same_as<Op, detail::bit_or> || std::same_as<Op, detail::bit_xor>;
+                std::vector<std::uint16_t> keys;
+                std::vector<chunk> chunks;
+                auto i = 0;
+                auto j = 0;
+                while (i < this->num_chunks() || j < other.num_chunks()) {
+                        if (j == other.num_chunks() || (i < this->num_chunks() && this->m_keys[index(i)] < other.m_keys[index(j)])) {
+                                if constexpr (keep_lhs) {
+                                        keys.push_back(this->m_keys[index(i)]);
+                                        chunks.push_back(std::move(this->m_chunks[index(i)]));
+                                }
+                                ++i;
+                        } else if (i == this->num_chunks() || other.m_keys[index(j)] < this->m_keys[index(i)]) {
+                                if constexpr (keep_rhs) {
+                                        keys.push_back(other.m_keys[index(j)]);
+                                        chunks.push_back(other.m_chunks[index(j)]);
+                                }
+                                ++j;
+                        } else {
+                                if (auto c = detail::roaring::combine<Op>(this->m_chunks[index(i)], other.m_chunks[index(j)]); !detail::roaring::is_empty(c)) {
+                                        keys.push_back(this->m_keys[index(i)]);
+                                        chunks.push_back(std::move(c));
+                                }
+                                ++i;
+                                ++j;
+                        }
+                }
+                this->m_keys = std::move(keys);
+                this->m_chunks = std::move(chunks);
+                return *this;
+        }
+
+public:
+        compressed_bit_set() = default;
+
+        template<class InputIterator>
+        [[nodiscard]] compressed_bit_set(InputIterator first, InputIterator last)
+                requires std::input_iterator<InputIterator>
+        {
+                insert(first, last);
+        }
+
+        [[nodiscard]] compressed_bit_set(std::initializer_list<value_type> ilist)
+        :
+                compressed_bit_set(ilist.begin(), ilist.end())
+        {}
+
+        auto& operator=(std::initializer_list<value_type> ilist)
+        {
+                clear();
+                insert(ilist.begin(), ilist.end());
+                return *this;
+        }
+
+        [[nodiscard]] auto operator==(compressed_bit_set const& other) const
+                -> bool
+        {
+                return this->m_keys == other.m_keys && std::ranges::equal(this->m_chunks, other.m_chunks, detail::roaring::equal);
+        }
+
+        [[nodiscard]] auto operator<=>(compressed_bit_set const& other) const
+                -> std::strong_ordering
+        {
+                return std::lexicographical_compare_three_way(this->begin(), this->end(), other.begin(), other.end());
+        }
+
+        [[nodiscard]] auto begin()   const noexcept -> const_iterator { return first_in(0); }
+        [[nodiscard]] auto end()     const noexcept -> const_iterator { return { this, num_chunks(), 0 }; }
+        [[nodiscard]] auto rbegin()  const noexcept { return const_reverse_iterator(end()); }
+        [[nodiscard]] auto rend()    const noexcept { return const_reverse_iterator(begin()); }
+        [[nodiscard]] auto cbegin()  const noexcept { return begin(); }
+        [[nodiscard]] auto cend()    const noexcept { return end(); }
+        [[nodiscard]] auto crbegin() const noexcept { return rbegin(); }
+        [[nodiscard]] auto crend()   const noexcept { return rend(); }
+
+        [[nodiscard]] auto front() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return *begin();
+        }
+
+        [[nodiscard]] auto back() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return *std::prev(end());
+        }
+
+        [[nodiscard]] auto empty() const noexcept
+                -> bool
+        {
+                return m_keys.empty();
+        }
+
+        [[nodiscard]] auto size() const noexcept
+                -> size_type
+        {
+                auto n = size_type(0);
+                for (auto const& c : m_chunks) {
+                        n += static_cast<size_type>(detail::roaring::cardinality(c));
+                }
+                return n;
+        }
+
+        [[nodiscard]] auto ssize() const noexcept
+        {
+                return static_cast<difference_type>(size());
+        }
+
+        [[nodiscard]] static constexpr auto max_size() noexcept
+        {
+                return size_type(1) << 32;
+        }
+
+        template<class... Args>
+        auto emplace(Args&&... args)
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        template<class... Args>
+        auto emplace_hint(const_iterator hint, Args&&... args)
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(hint, value_type(std::forward<Args>(args)...));
+        }
+
+        auto add(value_type x)
+        {
+                insert(x);
+        }
+
+        auto insert(value_type x)
+                -> std::pair<iterator, bool>
+        {
+                auto const i = chunk_index(key(x));
+                if (i == num_chunks() || m_keys[index(i)] != key(x)) {
+                        m_keys.insert(m_keys.begin() + i, key(x));
+                        m_chunks.insert(m_chunks.begin() + i, detail::roaring::array_chunk{ static_cast<std::uint16_t>(x) });
+                        return { { this, i, low(x) }, true };
+                }
+                auto const inserted = detail::roaring::insert(m_chunks[index(i)], low(x));
+                return { { this, i, low(x) }, inserted };
+        }
+
+        auto insert(const_iterator /* hint */, value_type x)
+                -> iterator
+        {
+                return insert(x).first;
+        }
+
+        // Consecutive values with the same upper 16 bits are inserted into their chunk in one go,
+        // after which the chunk re-picks its representation.
+        template<class InputIterator>
+        auto insert(InputIterator first, InputIterator last)
+                -> void
+                requires std::input_iterator<InputIterator> && std::constructible_from<value_type, decltype(*first)>
+        {
+                add_all(first, last);
+        }
+
+        template<class Range>
+        auto insert_range(Range&& rg)
+                requires std::ranges::range<Range> && std::constructible_from<value_type, decltype(*rg.begin())>
+        {
+                add_all(std::ranges::begin(rg), std::ranges::end(rg));
+        }
+
+        auto insert(std::initializer_list<value_type> ilist)
+        {
+                insert(ilist.begin(), ilist.end());
+        }
+
+        auto pop(key_type x)
+        {
+                erase(x);
+        }
+
+        auto erase(key_type x)
+                -> size_type
+        {
+                auto const i = chunk_index(key(x));
+                if (i == num_chunks() || m_keys[index(i)] != key(x) || !detail::roaring::erase(m_chunks[index(i)], low(x))) {
+                        return 0;
+                }
+                if (detail::roaring::is_empty(m_chunks[index(i)])) {
+                        erase_chunk(i);
+                }
+                return 1;
+        }
+
+        auto erase(const_iterator pos)
+                -> iterator
+        {
+                assert(pos != end());
+                auto const x = *pos;
+                erase(x);
+                return lower_bound(x);
+        }
+
+        auto erase(const_iterator first, const_iterator last)
+                -> iterator
+        {
+                if (first == last) {
+                        return last;
+                }
+                auto const x = *first;
+                erase_values(x, last == end() ? max_size() : *last);
+                return lower_bound(x);
+        }
+
+        auto swap(compressed_bit_set& other) noexcept
+        {
+                this->m_keys.swap(other.m_keys);
+                this->m_chunks.swap(other.m_chunks);
+        }
+
+        auto clear() noexcept
+                -> void
+        {
+                m_keys.clear();
+                m_chunks.clear();
+        }
+
+        [[nodiscard]] auto find(key_type x) const
+        {
+                return contains(x) ? const_iterator(this, chunk_index(key(x)), low(x)) : end();
+        }
+
+        [[nodiscard]] auto count(key_type x) const
+                -> size_type
+        {
+                return contains(x);
+        }
+
+        [[nodiscard]] auto contains(key_type x) const
+                -> bool
+        {
+                auto const i = chunk_index(key(x));
+                return i != num_chunks() && m_keys[index(i)] == key(x) && std::visit([&](auto const& c) {
+                        return detail::roaring::contains(c, low(x));
+                }, m_chunks[index(i)]);
+        }
+
+        [[nodiscard]] auto lower_bound(key_type x) const
+                -> const_iterator
+        {
+                auto i = chunk_index(key(x));
+                if (i != num_chunks() && m_keys[index(i)] == key(x)) {
+                        if (auto const y = detail::roaring::next(m_chunks[index(i)], low(x)); y < detail::roaring::chunk_size) {
+                                return { this, i, y };
+                        }
+                        ++i;
+                }
+                return first_in(i);
+        }
+
+        [[nodiscard]] auto upper_bound(key_type x) const
+                -> const_iterator
+        {
+                return x == max_size() - 1 ? end() : lower_bound(x + 1);
+        }
+
+        [[nodiscard]] auto equal_range(key_type x) const
+                -> std::pair<const_iterator, const_iterator>
+        {
+                return { lower_bound(x), upper_bound(x) };
+        }
+
+        auto& operator&=(compressed_bit_set const& other)
+        {
+                return merge<detail::bit_and>(other);
+        }
+
+        auto& operator|=(compressed_bit_set const& other)
+        {
+                return merge<detail::bit_or>(other);
+        }
+
+        auto& operator^=(compressed_bit_set const& other)
+        {
+                return merge<detail::bit_xor>(other);
+        }
+
+        auto& operator-=(compressed_bit_set const& other)
+        {
+                return merge<detail::bit_minus>(other);
+        }
+
+        [[nodiscard]] auto is_subset_of(compressed_bit_set const& other) const
+        {
+                auto j = 0;
+                for (auto i = 0; i < this->num_chunks(); ++i) {
+                        for (/* init-statement before loop */; j < other.num_chunks() && other.m_keys[index(j)] < this->m_keys[index(i)]; ++j) {}
+                        if (j == other.num_chunks() || other.m_keys[index(j)] != this->m_keys[index(i)]) {
+                                return false;
+                        }
+                        if (!detail::roaring::is_empty(detail::roaring::evaluate<detail::bit_minus>(this->m_chunks[index(i)], other.m_chunks[index(j)]))) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+        [[nodiscard]] auto is_proper_subset_of(compressed_bit_set const& other) const
+        {
+                return is_subset_of(other) && this->size() != other.size();
+        }
+
+        [[nodiscard]] auto intersects(compressed_bit_set const& other) const
+                -> bool
+        {
+                for (auto i = 0, j = 0; i < this->num_chunks() && j < other.num_chunks(); /* increment inside loop */) {
+                        if (this->m_keys[index(i)] < other.m_keys[index(j)]) {
+                                ++i;
+                        } else if (other.m_keys[index(j)] < this->m_keys[index(i)]) {
+                                ++j;
+                        } else if (!detail::roaring::is_empty(detail::roaring::evaluate<detail::bit_and>(this->m_chunks[index(i++)], other.m_chunks[index(j++)]))) {
+                                return true;
+                        }
+                }
+                return false;
+        }
+
+        // Calls fun(x) for all elements x in ascending order, a chunk at a time.
+        template<class UnaryFunction>
+        auto for_each(UnaryFunction fun) const
+        {
+                for (auto i = 0; i < num_chunks(); ++i) {
+                        auto const base = static_cast<value_type>(m_keys[index(i)]) << detail::roaring::chunk_bits;
+                        std::visit([&](auto const& c) {
+                                detail::roaring::for_each(c, [&](int x) {
+                                        fun(base | static_cast<value_type>(x));
+                                });
+                        }, m_chunks[index(i)]);
+                }
+                return fun;
+        }
+
+        [[nodiscard]] auto to_vector() const
+                -> std::vector<value_type>
+        {
+                std::vector<value_type> nrv;
+                nrv.reserve(size());
+                for_each([&](auto x) {
+                        nrv.push_back(x);
+                });
+                return nrv;
+        }
+
+        class const_iterator
+        {
+        public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using difference_type   = compressed_bit_set::difference_type;
+                using value_type        = compressed_bit_set::value_type;
+                using pointer           = void;
+                using reference         = value_type;
+
+        private:
+                compressed_bit_set const* m_ptr = nullptr;
+                int m_index = 0;                // of the chunk
+                int m_low = 0;                  // lower 16 bits of the value
+
+        public:
+                const_iterator() = default;
+
+                [[nodiscard]] constexpr const_iterator(compressed_bit_set const* p, int i, int low) noexcept
+                :
+                        m_ptr(p),
+                        m_index(i),
+                        m_low(low)
+                {}
+
+                [[nodiscard]] constexpr auto operator==(const_iterator const& other) const noexcept
+                        -> bool
+                {
+                        assert(this->m_ptr == other.m_ptr);
+                        return this->m_index == other.m_index && this->m_low == other.m_low;
+                }
+
+                [[nodiscard]] auto operator*() const noexcept
+                        -> value_type
+                {
+                        assert(m_index < m_ptr->num_chunks());
+                        return static_cast<value_type>(m_ptr->m_keys[index(m_index)]) << detail::roaring::chunk_bits | static_cast<value_type>(m_low);
+                }
+
+                auto operator++() noexcept
+                        -> const_iterator&
+                {
+                        assert(m_index < m_ptr->num_chunks());
+                        m_low = detail::roaring::next(m_ptr->m_chunks[index(m_index)], m_low + 1);
+                        if (m_low == detail::roaring::chunk_size) {
+                                *this = m_ptr->first_in(m_index + 1);
+                        }
+                        return *this;
+                }
+
+                auto operator++(int) noexcept
+                        -> const_iterator
+                {
+                        auto nrv = *this; ++*this; return nrv;
+                }
+
+                auto operator--() noexcept
+                        -> const_iterator&
+                {
+                        if (m_index < m_ptr->num_chunks()) {
+                                if (auto const x = detail::roaring::prev(m_ptr->m_chunks[index(m_index)], m_low); x >= 0) {
+                                        m_low = x;
+                                        return *this;
+                                }
+                        }
+                        assert(m_index > 0);
+                        --m_index;
+                        m_low = detail::roaring::prev(m_ptr->m_chunks[index(m_index)], detail::roaring::chunk_size);
+                        return *this;
+                }
+
+                auto operator--(int) noexcept
+                        -> const_iterator
+                {
+                        auto nrv = *this; --*this; return nrv;
+                }
+        };
+
+};
+
+[[nodiscard]] inline auto operator&(compressed_bit_set const& lhs, compressed_bit_set const& rhs)
+{
+        auto nrv = lhs; nrv &= rhs; return nrv;
+}
+
+[[nodiscard]] inline auto operator|(compressed_bit_set const& lhs, compressed_bit_set const& rhs)
+{
+        auto nrv = lhs; nrv |= rhs; return nrv;
+}
+
+[[nodiscard]] inline auto operator^(compressed_bit_set const& lhs, compressed_bit_set const& rhs)
+{
+        auto nrv = lhs; nrv ^= rhs; return nrv;
+}
+
+[[nodiscard]] inline auto operator-(compressed_bit_set const& lhs, compressed_bit_set const& rhs)
+{
+        auto nrv = lhs; nrv -= rhs; return nrv;
+}
+
+inline auto swap(compressed_bit_set& lhs, compressed_bit_set& rhs) noexcept
+{
+        lhs.swap(rhs);
+}
+
+[[nodiscard]] inline auto begin(compressed_bit_set const& bs) noexcept
+{
+        return bs.begin();
+}
+
+[[nodiscard]] inline auto end(compressed_bit_set const& bs) noexcept
+{
+        return bs.end();
+}
+
+[[nodiscard]] inline auto size(compressed_bit_set const& bs) noexcept
+{
+        return bs.size();
+}
+
+[[nodiscard]] inline auto empty(compressed_bit_set const& bs) noexcept
+{
+        return bs.empty();
+}
+
+namespace detail {
+
+struct compressed_bit_set_access
+{
+        // The representation of each chunk: 0 for an array, 1 for a bitmap and 2 for runs.
+        [[nodiscard]] static auto kinds(compressed_bit_set const& bs)
+                -> std::vector<std::size_t>
+        {
+                std::vector<std::size_t> nrv;
+                for (auto const& c : bs.m_chunks) {
+                        nrv.push_back(c.index());
+                }
+                return nrv;
+        }
+};
+
+}       // namespace detail
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -0,0 +1,1415 @@
+#ifndef XSTD_DETAIL_BLOCK_KERNELS_HPP
+#define XSTD_DETAIL_BLOCK_KERNELS_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>            // copy_backward, copy_n, fill_n, min, reverse
+#include <array>                // array
+#include <bit>                  // bit_cast, countr_zero, endian, popcount
+#include <cassert>              // assert
+#include <concepts>             // same_as, unsigned_integral
+#include <cstddef>              // byte, size_t
+#include <cstdint>              // uint32_t, uint64_t
+#include <cstring>              // memcpy
+#include <initializer_list>     // initializer_list
+#include <limits>               // digits
+#include <string>               // char_traits
+#include <type_traits>          // is_constant_evaluated, remove_const_t
+
+#if defined(__GNUC__) && defined(__x86_64__)
+        #define XSTD_BLOCK_KERNELS_X86 1
+        // gcc 12 warns about the deliberately undefined pass-through operands in its AVX-512 headers
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wuninitialized"
+        #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+        #include <immintrin.h>  // __m256i, __m512i, _mm256_*, _mm512_*
+        #pragma GCC diagnostic pop
+#else
+        #define XSTD_BLOCK_KERNELS_X86 0
+#endif
+
+#if XSTD_BLOCK_KERNELS_X86
+        #define XSTD_TARGET_AVX2   __attribute__((target("avx2")))
+        #define XSTD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+        #define XSTD_TARGET_AVX512_VPOPCNTDQ __attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+        #define XSTD_TARGET_AVX512_VBMI2 __attribute__((target("avx512f,avx512bw,avx512vbmi2")))
+#endif
+
+// Kernels over contiguous arrays of blocks, shared by the multi-block code paths of the containers.
+// Each kernel is constexpr: during constant evaluation (and on platforms without runtime dispatch)
+// it runs a plain scalar loop, otherwise it dispatches on the instruction set detected at startup.
+// Bitwise kernels are oblivious to the order of elements within or across blocks,
+// so they operate on the raw bytes of the block array.
+
+namespace xstd::detail {
+
+enum class isa { scalar, avx2, avx512 };
+
+[[nodiscard]] inline auto is_supported(isa i) noexcept
+        -> bool
+{
+#if XSTD_BLOCK_KERNELS_X86
+        __builtin_cpu_init();
+        if (i == isa::avx512) {
+                return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        }
+        if (i == isa::avx2) {
+                return __builtin_cpu_supports("avx2");
+        }
+#endif
+        return i == isa::scalar;
+}
+
+[[nodiscard]] inline auto detect_isa() noexcept
+        -> isa
+{
+        for (auto i : { isa::avx512, isa::avx2 }) {
+                if (is_supported(i)) {
+                        return i;
+                }
+        }
+        return isa::scalar;
+}
+
+// The dispatch target for all kernels, detected once. It is exposed as an lvalue
+// so that tests and benchmarks can pin a (supported) instruction set.
+[[nodiscard]] inline auto active_isa() noexcept
+        -> isa&
+{
+        static auto value = detect_isa();
+        return value;
+}
+
+// Arrays shorter than this many bytes are not worth the cost of dispatching.
+inline constexpr auto min_vector_bytes = std::size_t(64);
+
+// Without a hardware popcount instruction (e.g. when targeting the x86-64 baseline),
+// std::popcount is a bit-twiddling sequence and the counting kernels win from a single AVX2 vector onwards.
+// With it, the AVX2 kernel never wins, and the AVX-512 kernel only does so from 512 bytes onwards.
+#if defined(__POPCNT__)
+inline constexpr auto has_popcnt = true;
+inline constexpr auto min_count_bytes = std::size_t(512);
+#else
+inline constexpr auto has_popcnt = false;
+inline constexpr auto min_count_bytes = std::size_t(32);
+#endif
+
+template<std::unsigned_integral Block>
+[[nodiscard]] constexpr auto use_vector(int n, std::size_t min_bytes = min_vector_bytes) noexcept
+{
+        return XSTD_BLOCK_KERNELS_X86 && static_cast<std::size_t>(n) * sizeof(Block) >= min_bytes;
+}
+
+struct bit_and
+{
+        template<std::unsigned_integral Block>
+        [[nodiscard]] static constexpr auto apply(Block lhs, Block rhs) noexcept
+        {
+                return static_cast<Block>(lhs & rhs);
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        [[nodiscard]] XSTD_TARGET_AVX2   static auto apply(__m256i lhs, __m256i rhs) noexcept { return _mm256_and_si256(lhs, rhs); }
+        [[nodiscard]] XSTD_TARGET_AVX512 static auto apply(__m512i lhs, __m512i rhs) noexcept { return _mm512_and_si512(lhs, rhs); }
+#endif
+};
+
+struct bit_or
+{
+        template<std::unsigned_integral Block>
+        [[nodiscard]] static constexpr auto apply(Block lhs, Block rhs) noexcept
+        {
+                return static_cast<Block>(lhs | rhs);
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        [[nodiscard]] XSTD_TARGET_AVX2   static auto apply(__m256i lhs, __m256i rhs) noexcept { return _mm256_or_si256(lhs, rhs); }
+        [[nodiscard]] XSTD_TARGET_AVX512 static auto apply(__m512i lhs, __m512i rhs) noexcept { return _mm512_or_si512(lhs, rhs); }
+#endif
+};
+
+struct bit_xor
+{
+        template<std::unsigned_integral Block>
+        [[nodiscard]] static constexpr auto apply(Block lhs, Block rhs) noexcept
+        {
+                return static_cast<Block>(lhs ^ rhs);
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        [[nodiscard]] XSTD_TARGET_AVX2   static auto apply(__m256i lhs, __m256i rhs) noexcept { return _mm256_xor_si256(lhs, rhs); }
+        [[nodiscard]] XSTD_TARGET_AVX512 static auto apply(__m512i lhs, __m512i rhs) noexcept { return _mm512_xor_si512(lhs, rhs); }
+#endif
+};
+
+struct bit_minus
+{
+        template<std::unsigned_integral Block>
+        [[nodiscard]] static constexpr auto apply(Block lhs, Block rhs) noexcept
+        {
+                return static_cast<Block>(lhs & static_cast<Block>(~rhs));
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        [[nodiscard]] XSTD_TARGET_AVX2   static auto apply(__m256i lhs, __m256i rhs) noexcept { return _mm256_andnot_si256(rhs, lhs); }
+        [[nodiscard]] XSTD_TARGET_AVX512 static auto apply(__m512i lhs, __m512i rhs) noexcept { return _mm512_andnot_si512(rhs, lhs); }
+#endif
+};
+
+#if XSTD_BLOCK_KERNELS_X86
+
+template<class T>
+[[nodiscard]] inline auto vector_ptr(void* p) noexcept
+{
+        return static_cast<T*>(p);
+}
+
+template<class T>
+[[nodiscard]] inline auto vector_ptr(void const* p) noexcept
+{
+        return static_cast<T const*>(p);
+}
+
+template<class Op, std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto transform_avx2(Block* dst, Block const* src, int n) noexcept
+{
+        auto const d = reinterpret_cast<unsigned char*>(dst);
+        auto const s = reinterpret_cast<unsigned char const*>(src);
+        auto const num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        auto const num_vector_bytes = num_bytes / 32 * 32;
+        for (auto i = std::size_t(0); i < num_vector_bytes; i += 32) {
+                auto const lhs = _mm256_loadu_si256(vector_ptr<__m256i>(d + i));
+                auto const rhs = _mm256_loadu_si256(vector_ptr<__m256i>(s + i));
+                _mm256_storeu_si256(vector_ptr<__m256i>(d + i), Op::apply(lhs, rhs));
+        }
+        for (auto j = num_vector_bytes / sizeof(Block); j < static_cast<std::size_t>(n); ++j) {
+                dst[j] = Op::apply(dst[j], src[j]);
+        }
+}
+
+template<class Op, std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto transform_avx512(Block* dst, Block const* src, int n) noexcept
+{
+        auto const d = reinterpret_cast<unsigned char*>(dst);
+        auto const s = reinterpret_cast<unsigned char const*>(src);
+        auto const num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= num_bytes; i += 64) {
+                auto const lhs = _mm512_loadu_si512(d + i);
+                auto const rhs = _mm512_loadu_si512(s + i);
+                _mm512_storeu_si512(d + i, Op::apply(lhs, rhs));
+        }
+        if (i < num_bytes) {
+                auto const tail = static_cast<__mmask64>((~0ULL) >> (64 - (num_bytes - i)));
+                auto const lhs = _mm512_maskz_loadu_epi8(tail, d + i);
+                auto const rhs = _mm512_maskz_loadu_epi8(tail, s + i);
+                _mm512_mask_storeu_epi8(d + i, tail, Op::apply(lhs, rhs));
+        }
+}
+
+#endif
+
+// dst[i] = Op(dst[i], src[i]) for all 0 <= i < n
+template<class Op, std::unsigned_integral Block>
+constexpr auto transform(Block* dst, Block const* src, int n) noexcept
+{
+#if XSTD_BLOCK_KERNELS_X86
+        if (!std::is_constant_evaluated() && use_vector<Block>(n)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return transform_avx512<Op>(dst, src, n);
+                } else if (i == isa::avx2) {
+                        return transform_avx2<Op>(dst, src, n);
+                }
+        }
+#endif
+        // C++23 (currently available in range-v3)
+        // for (auto&& [lhs, rhs] : ranges::views::zip(std::span(dst, n), std::span(src, n))) {
+        //         lhs = Op::apply(lhs, rhs);
+        // }
+        for (auto i = 0; i < n; ++i) {
+                dst[i] = Op::apply(dst[i], src[i]);
+        }
+}
+
+// The left operand as is, so that the binary counting kernels also count a single array.
+struct bit_lhs
+{
+        template<std::unsigned_integral Block>
+        [[nodiscard]] static constexpr auto apply(Block lhs, Block /* rhs */) noexcept
+        {
+                return lhs;
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        [[nodiscard]] XSTD_TARGET_AVX2   static auto apply(__m256i lhs, __m256i /* rhs */) noexcept { return lhs; }
+        [[nodiscard]] XSTD_TARGET_AVX512 static auto apply(__m512i lhs, __m512i /* rhs */) noexcept { return lhs; }
+#endif
+};
+
+#if XSTD_BLOCK_KERNELS_X86
+
+[[nodiscard]] inline auto has_vpopcntdq() noexcept
+        -> bool
+{
+        static auto const value = is_supported(isa::avx512) && __builtin_cpu_supports("avx512vpopcntdq");
+        return value;
+}
+
+// Harley-Seal carry-save adder: (h, l) = a + b + c, with h the carry bits and l the sum bits.
+XSTD_TARGET_AVX2 inline auto csa(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c) noexcept
+{
+        auto const u = _mm256_xor_si256(a, b);
+        h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+        l = _mm256_xor_si256(u, c);
+}
+
+XSTD_TARGET_AVX512 inline auto csa(__m512i& h, __m512i& l, __m512i a, __m512i b, __m512i c) noexcept
+{
+        h = _mm512_ternarylogic_epi64(a, b, c, 0xE8);  // majority
+        l = _mm512_ternarylogic_epi64(a, b, c, 0x96);  // parity
+}
+
+// Per 64-bit lane popcounts through nibble lookups (Mula, Kurz and Lemire, 2016).
+XSTD_TARGET_AVX2 inline auto popcount_epi64(__m256i v) noexcept
+{
+        auto const lookup = _mm256_setr_epi8(
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+        );
+        auto const low_mask = _mm256_set1_epi8(0x0F);
+        auto const lo = _mm256_and_si256(v, low_mask);
+        auto const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        auto const cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+XSTD_TARGET_AVX512 inline auto popcount_epi64(__m512i v) noexcept
+{
+        auto const lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+        auto const low_mask = _mm512_set1_epi8(0x0F);
+        auto const lo = _mm512_and_si512(v, low_mask);
+        auto const hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask);
+        auto const cnt = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, lo), _mm512_shuffle_epi8(lookup, hi));
+        return _mm512_sad_epu8(cnt, _mm512_setzero_si512());
+}
+
+XSTD_TARGET_AVX2 inline auto reduce_add_epi64(__m256i v) noexcept
+{
+        auto const sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        return static_cast<int>(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+XSTD_TARGET_AVX512 inline auto reduce_add_epi64(__m512i v) noexcept
+{
+        return static_cast<int>(_mm512_reduce_add_epi64(v));
+}
+
+template<class Op>
+XSTD_TARGET_AVX2 inline auto load_avx2(unsigned char const* l, unsigned char const* r, std::size_t i) noexcept
+{
+        return Op::apply(_mm256_loadu_si256(vector_ptr<__m256i>(l + i)), _mm256_loadu_si256(vector_ptr<__m256i>(r + i)));
+}
+
+template<class Op>
+XSTD_TARGET_AVX512 inline auto load_avx512(unsigned char const* l, unsigned char const* r, std::size_t i) noexcept
+{
+        return Op::apply(_mm512_loadu_si512(l + i), _mm512_loadu_si512(r + i));
+}
+
+// Harley-Seal popcount over 16 vectors at a time, followed by a vector and a scalar tail.
+template<class Op, std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto count_avx2(Block const* lhs, Block const* rhs, int n) noexcept
+{
+        auto const l = reinterpret_cast<unsigned char const*>(lhs);
+        auto const r = reinterpret_cast<unsigned char const*>(rhs);
+        auto const num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        auto total = _mm256_setzero_si256();
+        auto ones = _mm256_setzero_si256(), twos = ones, fours = ones, eights = ones, sixteens = ones;
+        auto twos_a = ones, twos_b = ones, fours_a = ones, fours_b = ones, eights_a = ones, eights_b = ones;
+        auto i = std::size_t(0);
+        if (num_bytes >= 16 * 32) {
+                for (/* init-statement before loop */; i + 16 * 32 <= num_bytes; i += 16 * 32) {
+                        csa(twos_a,   ones,   ones,   load_avx2<Op>(l, r, i +  0 * 32), load_avx2<Op>(l, r, i +  1 * 32));
+                        csa(twos_b,   ones,   ones,   load_avx2<Op>(l, r, i +  2 * 32), load_avx2<Op>(l, r, i +  3 * 32));
+                        csa(fours_a,  twos,   twos,   twos_a,                           twos_b);
+                        csa(twos_a,   ones,   ones,   load_avx2<Op>(l, r, i +  4 * 32), load_avx2<Op>(l, r, i +  5 * 32));
+                        csa(twos_b,   ones,   ones,   load_avx2<Op>(l, r, i +  6 * 32), load_avx2<Op>(l, r, i +  7 * 32));
+                        csa(fours_b,  twos,   twos,   twos_a,                           twos_b);
+                        csa(eights_a, fours,  fours,  fours_a,                          fours_b);
+                        csa(twos_a,   ones,   ones,   load_avx2<Op>(l, r, i +  8 * 32), load_avx2<Op>(l, r, i +  9 * 32));
+                        csa(twos_b,   ones,   ones,   load_avx2<Op>(l, r, i + 10 * 32), load_avx2<Op>(l, r, i + 11 * 32));
+                        csa(fours_a,  twos,   twos,   twos_a,                           twos_b);
+                        csa(twos_a,   ones,   ones,   load_avx2<Op>(l, r, i + 12 * 32), load_avx2<Op>(l, r, i + 13 * 32));
+                        csa(twos_b,   ones,   ones,   load_avx2<Op>(l, r, i + 14 * 32), load_avx2<Op>(l, r, i + 15 * 32));
+                        csa(fours_b,  twos,   twos,   twos_a,                           twos_b);
+                        csa(eights_b, fours,  fours,  fours_a,                          fours_b);
+                        csa(sixteens, eights, eights, eights_a,                         eights_b);
+                        total = _mm256_add_epi64(total, popcount_epi64(sixteens));
+                }
+                total = _mm256_slli_epi64(total, 4);
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64(eights), 3));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64(fours),  2));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64(twos),   1));
+                total = _mm256_add_epi64(total, popcount_epi64(ones));
+        }
+        for (/* init-statement before loop */; i + 32 <= num_bytes; i += 32) {
+                total = _mm256_add_epi64(total, popcount_epi64(load_avx2<Op>(l, r, i)));
+        }
+        auto sum = reduce_add_epi64(total);
+        for (auto j = i / sizeof(Block); j < static_cast<std::size_t>(n); ++j) {
+                sum += std::popcount(Op::apply(lhs[j], rhs[j]));
+        }
+        return sum;
+}
+
+// VPOPCNTQ on 64 bytes at a time, followed by a masked tail.
+template<class Op, std::unsigned_integral Block>
+XSTD_TARGET_AVX512_VPOPCNTDQ inline auto count_avx512_vpopcntdq(Block const* lhs, Block const* rhs, int n) noexcept
+{
+        auto const l = reinterpret_cast<unsigned char const*>(lhs);
+        auto const r = reinterpret_cast<unsigned char const*>(rhs);
+        auto const num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        auto total = _mm512_setzero_si512();
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= num_bytes; i += 64) {
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(load_avx512<Op>(l, r, i)));
+        }
+        if (i < num_bytes) {
+                auto const tail = static_cast<__mmask64>((~0ULL) >> (64 - (num_bytes - i)));
+                auto const v = Op::apply(_mm512_maskz_loadu_epi8(tail, l + i), _mm512_maskz_loadu_epi8(tail, r + i));
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+        }
+        return reduce_add_epi64(total);
+}
+
+// Harley-Seal popcount over 16 vectors at a time, followed by a vector and a masked tail.
+template<class Op, std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto count_avx512(Block const* lhs, Block const* rhs, int n) noexcept
+{
+        auto const l = reinterpret_cast<unsigned char const*>(lhs);
+        auto const r = reinterpret_cast<unsigned char const*>(rhs);
+        auto const num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        auto total = _mm512_setzero_si512();
+        auto ones = _mm512_setzero_si512(), twos = ones, fours = ones, eights = ones, sixteens = ones;
+        auto twos_a = ones, twos_b = ones, fours_a = ones, fours_b = ones, eights_a = ones, eights_b = ones;
+        auto i = std::size_t(0);
+        if (num_bytes >= 16 * 64) {
+                for (/* init-statement before loop */; i + 16 * 64 <= num_bytes; i += 16 * 64) {
+                        csa(twos_a,   ones,   ones,   load_avx512<Op>(l, r, i +  0 * 64), load_avx512<Op>(l, r, i +  1 * 64));
+                        csa(twos_b,   ones,   ones,   load_avx512<Op>(l, r, i +  2 * 64), load_avx512<Op>(l, r, i +  3 * 64));
+                        csa(fours_a,  twos,   twos,   twos_a,                             twos_b);
+                        csa(twos_a,   ones,   ones,   load_avx512<Op>(l, r, i +  4 * 64), load_avx512<Op>(l, r, i +  5 * 64));
+                        csa(twos_b,   ones,   ones,   load_avx512<Op>(l, r, i +  6 * 64), load_avx512<Op>(l, r, i +  7 * 64));
+                        csa(fours_b,  twos,   twos,   twos_a,                             twos_b);
+                        csa(eights_a, fours,  fours,  fours_a,                            fours_b);
+                        csa(twos_a,   ones,   ones,   load_avx512<Op>(l, r, i +  8 * 64), load_avx512<Op>(l, r, i +  9 * 64));
+                        csa(twos_b,   ones,   ones,   load_avx512<Op>(l, r, i + 10 * 64), load_avx512<Op>(l, r, i + 11 * 64));
+                        csa(fours_a,  twos,   twos,   twos_a,                             twos_b);
+                        csa(twos_a,   ones,   ones,   load_avx512<Op>(l, r, i + 12 * 64), load_avx512<Op>(l, r, i + 13 * 64));
+                        csa(twos_b,   ones,   ones,   load_avx512<Op>(l, r, i + 14 * 64), load_avx512<Op>(l, r, i + 15 * 64));
+                        csa(fours_b,  twos,   twos,   twos_a,                             twos_b);
+                        csa(eights_b, fours,  fours,  fours_a,                            fours_b);
+                        csa(sixteens, eights, eights, eights_a,                           eights_b);
+                        total = _mm512_add_epi64(total, popcount_epi64(sixteens));
+                }
+                total = _mm512_slli_epi64(total, 4);
+                total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64(eights), 3));
+                total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64(fours),  2));
+                total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64(twos),   1));
+                total = _mm512_add_epi64(total, popcount_epi64(ones));
+        }
+        for (/* init-statement before loop */; i + 64 <= num_bytes; i += 64) {
+                total = _mm512_add_epi64(total, popcount_epi64(load_avx512<Op>(l, r, i)));
+        }
+        if (i < num_bytes) {
+                auto const tail = static_cast<__mmask64>((~0ULL) >> (64 - (num_bytes - i)));
+                auto const v = Op::apply(_mm512_maskz_loadu_epi8(tail, l + i), _mm512_maskz_loadu_epi8(tail, r + i));
+                total = _mm512_add_epi64(total, popcount_epi64(v));
+        }
+        return reduce_add_epi64(total);
+}
+
+#endif
+
+// The number of 1-bits in Op(lhs[i], rhs[i]) summed over all 0 <= i < n
+template<class Op, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto count(Block const* lhs, Block const* rhs, int n) noexcept
+        -> int
+{
+#if XSTD_BLOCK_KERNELS_X86
+        if (!std::is_constant_evaluated() && use_vector<Block>(n, min_count_bytes)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return has_vpopcntdq() ? count_avx512_vpopcntdq<Op>(lhs, rhs, n) : count_avx512<Op>(lhs, rhs, n);
+                } else if (i == isa::avx2 && !has_popcnt) {
+                        return count_avx2<Op>(lhs, rhs, n);
+                }
+        }
+#endif
+        auto sum = 0;
+        for (auto i = 0; i < n; ++i) {
+                sum += std::popcount(Op::apply(lhs[i], rhs[i]));
+        }
+        return sum;
+}
+
+// The number of 1-bits in src[i] summed over all 0 <= i < n
+template<std::unsigned_integral Block>
+[[nodiscard]] constexpr auto popcount(Block const* src, int n) noexcept
+{
+        return count<bit_lhs>(src, src, n);
+}
+
+#if XSTD_BLOCK_KERNELS_X86
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto any_avx2(Block const* src) noexcept
+{
+        auto const v = _mm256_loadu_si256(vector_ptr<__m256i>(src));
+        return !_mm256_testz_si256(v, v);
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto any_avx512(Block const* src) noexcept
+{
+        auto const v = _mm512_loadu_si512(src);
+        return _mm512_test_epi64_mask(v, v) != 0;
+}
+
+// Skip over 32 or 64 bytes of zero blocks at a time, then locate the non-zero block within the vector.
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto first_nonzero_avx2(Block const* src, int n) noexcept
+{
+        constexpr auto stride = static_cast<int>(32 / sizeof(Block));
+        auto i = 0;
+        while (i + stride <= n && !any_avx2(src + i)) {
+                i += stride;
+        }
+        for (/* init-statement before loop */; i < n && !src[i]; ++i) {}
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto first_nonzero_avx512(Block const* src, int n) noexcept
+{
+        constexpr auto stride = static_cast<int>(64 / sizeof(Block));
+        auto i = 0;
+        while (i + stride <= n && !any_avx512(src + i)) {
+                i += stride;
+        }
+        for (/* init-statement before loop */; i < n && !src[i]; ++i) {}
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto last_nonzero_avx2(Block const* src, int n) noexcept
+{
+        constexpr auto stride = static_cast<int>(32 / sizeof(Block));
+        auto i = n;
+        while (i - stride >= 0 && !any_avx2(src + i - stride)) {
+                i -= stride;
+        }
+        for (--i; i >= 0 && !src[i]; --i) {}
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto last_nonzero_avx512(Block const* src, int n) noexcept
+{
+        constexpr auto stride = static_cast<int>(64 / sizeof(Block));
+        auto i = n;
+        while (i - stride >= 0 && !any_avx512(src + i - stride)) {
+                i -= stride;
+        }
+        for (--i; i >= 0 && !src[i]; --i) {}
+        return i;
+}
+
+#endif
+
+// The smallest 0 <= i < n with src[i] != 0, or n if there is none
+template<std::unsigned_integral Block>
+[[nodiscard]] constexpr auto first_nonzero(Block const* src, int n) noexcept
+        -> int
+{
+        // dense sets should not pay for dispatching
+        if (n == 0 || src[0]) {
+                return 0;
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        if (!std::is_constant_evaluated() && use_vector<Block>(n - 1)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return 1 + first_nonzero_avx512(src + 1, n - 1);
+                } else if (i == isa::avx2) {
+                        return 1 + first_nonzero_avx2(src + 1, n - 1);
+                }
+        }
+#endif
+        auto i = 1;
+        for (/* init-statement before loop */; i < n && !src[i]; ++i) {}
+        return i;
+}
+
+// The largest 0 <= i < n with src[i] != 0, or -1 if there is none
+template<std::unsigned_integral Block>
+[[nodiscard]] constexpr auto last_nonzero(Block const* src, int n) noexcept
+        -> int
+{
+        // dense sets should not pay for dispatching
+        if (n == 0 || src[n - 1]) {
+                return n - 1;
+        }
+#if XSTD_BLOCK_KERNELS_X86
+        if (!std::is_constant_evaluated() && use_vector<Block>(n - 1)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return last_nonzero_avx512(src, n - 1);
+                } else if (i == isa::avx2) {
+                        return last_nonzero_avx2(src, n - 1);
+                }
+        }
+#endif
+        auto i = n - 2;
+        for (/* init-statement before loop */; i >= 0 && !src[i]; --i) {}
+        return i;
+}
+
+// Writes the elements of a single block in ascending order to out, and returns the past-the-end pointer.
+// Elements are ordered from the most significant bit down, so the positions are filled back to front,
+// which keeps the loop-carried dependency down to the single-cycle clearing of the lowest 1-bit.
+template<std::unsigned_integral Block>
+constexpr auto decode_block(Block block, int base, int* out) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        auto const last = out + std::popcount(block);
+        for (auto p = last; block; block &= static_cast<Block>(block - 1)) {
+                *--p = base + block_size - 1 - std::countr_zero(block);
+        }
+        return last;
+}
+
+#if XSTD_BLOCK_KERNELS_X86
+
+// Compresses the element values of each 16-bit slice of a block into consecutive lanes.
+// Slices are most significant bit first, so the lanes hold the values in descending order
+// and are reversed before being stored. Sparse blocks are cheaper to decode bit by bit.
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto decode_avx512(Block const* src, int n, int* out) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static_assert(block_size % 16 == 0);
+        constexpr auto min_vector_popcount = block_size / 8;
+        auto const ascending  = _mm512_setr_epi32( 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15);
+        auto const descending = _mm512_setr_epi32(15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0);
+        auto const first = out;
+        for (auto i = n - 1, base = 0; i >= 0; --i, base += block_size) {
+                if (std::popcount(src[i]) < min_vector_popcount) {
+                        out = decode_block(src[i], base, out);
+                        continue;
+                }
+                for (auto j = 0; j < block_size; j += 16) {
+                        auto const mask = static_cast<__mmask16>(src[i] >> (block_size - 16 - j));
+                        auto const c = std::popcount(static_cast<unsigned>(mask));
+                        auto const values = _mm512_maskz_compress_epi32(mask, _mm512_add_epi32(descending, _mm512_set1_epi32(base + j)));
+                        auto const reversed = _mm512_permutexvar_epi32(_mm512_sub_epi32(_mm512_set1_epi32(c - 1), ascending), values);
+                        _mm512_mask_storeu_epi32(out, static_cast<__mmask16>((1u << c) - 1), reversed);
+                        out += c;
+                }
+        }
+        return static_cast<int>(out - first);
+}
+
+#endif
+
+// Writes the elements encoded in the layout of xstd::bit_set and xstd::dynamic_bit_set (element x at
+// bit digits - 1 - x % digits of src[n - 1 - x / digits]) in ascending order to out, and returns the
+// number of elements written.
+template<std::unsigned_integral Block>
+constexpr auto decode(Block const* src, int n, int* out) noexcept
+        -> int
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+#if XSTD_BLOCK_KERNELS_X86
+        if constexpr (block_size % 16 == 0) {
+                if (!std::is_constant_evaluated() && active_isa() == isa::avx512) {
+                        return decode_avx512(src, n, out);
+                }
+        }
+#endif
+        auto const first = out;
+        for (auto i = n - 1, base = 0; i >= 0; --i, base += block_size) {
+                if (src[i]) {
+                        out = decode_block(src[i], base, out);
+                }
+        }
+        return static_cast<int>(out - first);
+}
+
+#if XSTD_BLOCK_KERNELS_X86
+
+[[nodiscard]] inline auto has_vbmi2() noexcept
+        -> bool
+{
+        static auto const value = is_supported(isa::avx512) && __builtin_cpu_supports("avx512vbmi2");
+        return value;
+}
+
+// Funnel shifts of 64-bit blocks: each output block combines two neighbouring input blocks,
+// read with two overlapping unaligned loads. Right shifts run upwards and left shifts run downwards,
+// so that every input block is read before it is overwritten. They return the first block left to do.
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto shift_right_avx2(Block* data, int n, int n_block, int R_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const R = _mm_cvtsi32_si128(R_shift);
+        auto const L = _mm_cvtsi32_si128(64 - R_shift);
+        auto i = 0;
+        for (/* init-statement before loop */; i + 4 <= n - 1 - n_block; i += 4) {
+                auto const lo = _mm256_loadu_si256(vector_ptr<__m256i>(data + i + n_block));
+                auto const hi = _mm256_loadu_si256(vector_ptr<__m256i>(data + i + n_block + 1));
+                _mm256_storeu_si256(vector_ptr<__m256i>(data + i), _mm256_or_si256(_mm256_srl_epi64(lo, R), _mm256_sll_epi64(hi, L)));
+        }
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto shift_right_avx512(Block* data, int n, int n_block, int R_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const R = _mm_cvtsi32_si128(R_shift);
+        auto const L = _mm_cvtsi32_si128(64 - R_shift);
+        auto i = 0;
+        for (/* init-statement before loop */; i + 8 <= n - 1 - n_block; i += 8) {
+                auto const lo = _mm512_loadu_si512(data + i + n_block);
+                auto const hi = _mm512_loadu_si512(data + i + n_block + 1);
+                _mm512_storeu_si512(data + i, _mm512_or_si512(_mm512_srl_epi64(lo, R), _mm512_sll_epi64(hi, L)));
+        }
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512_VBMI2 inline auto shift_right_vbmi2(Block* data, int n, int n_block, int R_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const R = _mm512_set1_epi64(R_shift);
+        auto i = 0;
+        for (/* init-statement before loop */; i + 8 <= n - 1 - n_block; i += 8) {
+                auto const lo = _mm512_loadu_si512(data + i + n_block);
+                auto const hi = _mm512_loadu_si512(data + i + n_block + 1);
+                _mm512_storeu_si512(data + i, _mm512_shrdv_epi64(lo, hi, R));
+        }
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto shift_left_avx2(Block* data, int n, int n_block, int L_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const L = _mm_cvtsi32_si128(L_shift);
+        auto const R = _mm_cvtsi32_si128(64 - L_shift);
+        auto i = n - 1;
+        for (/* init-statement before loop */; i - 4 >= n_block; i -= 4) {
+                auto const hi = _mm256_loadu_si256(vector_ptr<__m256i>(data + i - 3 - n_block));
+                auto const lo = _mm256_loadu_si256(vector_ptr<__m256i>(data + i - 4 - n_block));
+                _mm256_storeu_si256(vector_ptr<__m256i>(data + i - 3), _mm256_or_si256(_mm256_sll_epi64(hi, L), _mm256_srl_epi64(lo, R)));
+        }
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto shift_left_avx512(Block* data, int n, int n_block, int L_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const L = _mm_cvtsi32_si128(L_shift);
+        auto const R = _mm_cvtsi32_si128(64 - L_shift);
+        auto i = n - 1;
+        for (/* init-statement before loop */; i - 8 >= n_block; i -= 8) {
+                auto const hi = _mm512_loadu_si512(data + i - 7 - n_block);
+                auto const lo = _mm512_loadu_si512(data + i - 8 - n_block);
+                _mm512_storeu_si512(data + i - 7, _mm512_or_si512(_mm512_sll_epi64(hi, L), _mm512_srl_epi64(lo, R)));
+        }
+        return i;
+}
+
+template<std::unsigned_integral Block>
+XSTD_TARGET_AVX512_VBMI2 inline auto shift_left_vbmi2(Block* data, int n, int n_block, int L_shift) noexcept
+{
+        static_assert(sizeof(Block) == 8);
+        auto const L = _mm512_set1_epi64(L_shift);
+        auto i = n - 1;
+        for (/* init-statement before loop */; i - 8 >= n_block; i -= 8) {
+                auto const hi = _mm512_loadu_si512(data + i - 7 - n_block);
+                auto const lo = _mm512_loadu_si512(data + i - 8 - n_block);
+                _mm512_storeu_si512(data + i - 7, _mm512_shldv_epi64(hi, lo, L));
+        }
+        return i;
+}
+
+#endif
+
+// Shifts the multi-word integer data[n - 1] ... data[0] right by 0 <= count < n * digits bits, in place.
+// For xstd::bit_set, this is a shift of all elements to higher values.
+template<std::unsigned_integral Block>
+constexpr auto shift_right(Block* data, int n, int count) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        if (count == 0) {
+                return;
+        }
+        auto const n_block = count / block_size;
+        auto const R_shift = count % block_size;
+        if (R_shift == 0) {
+                std::ranges::copy_n(data + n_block, n - n_block, data);
+        } else {
+                auto const L_shift = block_size - R_shift;
+                auto i = 0;
+#if XSTD_BLOCK_KERNELS_X86
+                if constexpr (sizeof(Block) == 8) {
+                        if (!std::is_constant_evaluated() && use_vector<Block>(n - 1 - n_block)) {
+                                if (auto const target = active_isa(); target == isa::avx512) {
+                                        i = has_vbmi2() ? shift_right_vbmi2(data, n, n_block, R_shift) : shift_right_avx512(data, n, n_block, R_shift);
+                                } else if (target == isa::avx2) {
+                                        i = shift_right_avx2(data, n, n_block, R_shift);
+                                }
+                        }
+                }
+#endif
+                for (/* init-statement before loop */; i < n - 1 - n_block; ++i) {
+                        data[i] =
+                                static_cast<Block>(data[i + n_block    ] >> R_shift) |
+                                static_cast<Block>(data[i + n_block + 1] << L_shift)
+                        ;
+                }
+                data[n - 1 - n_block] = static_cast<Block>(data[n - 1] >> R_shift);
+        }
+        std::ranges::fill_n(data + n - n_block, n_block, Block(0));
+}
+
+// Shifts the multi-word integer data[n - 1] ... data[0] left by 0 <= count < n * digits bits, in place.
+// For xstd::bit_set, this is a shift of all elements to lower values.
+template<std::unsigned_integral Block>
+constexpr auto shift_left(Block* data, int n, int count) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        if (count == 0) {
+                return;
+        }
+        auto const n_block = count / block_size;
+        auto const L_shift = count % block_size;
+        if (L_shift == 0) {
+                std::ranges::copy_backward(data, data + n - n_block, data + n);
+        } else {
+                auto const R_shift = block_size - L_shift;
+                auto i = n - 1;
+#if XSTD_BLOCK_KERNELS_X86
+                if constexpr (sizeof(Block) == 8) {
+                        if (!std::is_constant_evaluated() && use_vector<Block>(n - 1 - n_block)) {
+                                if (auto const target = active_isa(); target == isa::avx512) {
+                                        i = has_vbmi2() ? shift_left_vbmi2(data, n, n_block, L_shift) : shift_left_avx512(data, n, n_block, L_shift);
+                                } else if (target == isa::avx2) {
+                                        i = shift_left_avx2(data, n, n_block, L_shift);
+                                }
+                        }
+                }
+#endif
+                for (/* init-statement before loop */; i > n_block; --i) {
+                        data[i] =
+                                static_cast<Block>(data[i - n_block    ] << L_shift) |
+                                static_cast<Block>(data[i - n_block - 1] >> R_shift)
+                        ;
+                }
+                data[n_block] = static_cast<Block>(data[0] << L_shift);
+        }
+        std::ranges::fill_n(data, n_block, Block(0));
+}
+
+#if XSTD_BLOCK_KERNELS_X86
+
+// Byte reversal of 32 or 64 bytes at a time: a shuffle reverses the bytes within each 128-bit lane,
+// and a permutation reverses the lanes. They return the number of bytes done.
+XSTD_TARGET_AVX2 inline auto reverse_bytes_avx2(unsigned char const* src, std::size_t n, unsigned char* dst) noexcept
+        -> std::size_t
+{
+        auto const lane = _mm256_setr_epi8(
+                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+        );
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 32 <= n; i += 32) {
+                auto const v = _mm256_shuffle_epi8(_mm256_loadu_si256(vector_ptr<__m256i>(src + n - 32 - i)), lane);
+                _mm256_storeu_si256(vector_ptr<__m256i>(dst + i), _mm256_permute4x64_epi64(v, 0x4E));
+        }
+        return i;
+}
+
+XSTD_TARGET_AVX512 inline auto reverse_bytes_avx512(unsigned char const* src, std::size_t n, unsigned char* dst) noexcept
+        -> std::size_t
+{
+        auto const lane = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+        auto const lanes = _mm512_setr_epi64(6, 7, 4, 5, 2, 3, 0, 1);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= n; i += 64) {
+                auto const v = _mm512_shuffle_epi8(_mm512_loadu_si512(src + n - 64 - i), lane);
+                _mm512_storeu_si512(dst + i, _mm512_permutexvar_epi64(lanes, v));
+        }
+        return i;
+}
+
+#endif
+
+// dst[i] = src[n - 1 - i] for all 0 <= i < n, for non-overlapping arrays
+inline auto reverse_bytes(unsigned char const* src, std::size_t n, unsigned char* dst) noexcept
+{
+        auto i = std::size_t(0);
+#if XSTD_BLOCK_KERNELS_X86
+        if (n >= min_vector_bytes) {
+                if (auto const target = active_isa(); target == isa::avx512) {
+                        i = reverse_bytes_avx512(src, n, dst);
+                } else if (target == isa::avx2) {
+                        i = reverse_bytes_avx2(src, n, dst);
+                }
+        }
+#endif
+        for (/* init-statement before loop */; i < n; ++i) {
+                dst[i] = src[n - 1 - i];
+        }
+}
+
+// Stores the multi-word integer data[n - 1] ... data[0] as big-endian bytes, truncated to its
+// num_bytes most significant bytes, with (n - 1) * sizeof(Block) < num_bytes <= n * sizeof(Block).
+// For xstd::bit_set, out[i] holds the elements 8 * i to 8 * i + 7, from the most significant bit down.
+// On little-endian machines, this is the reversal of the trailing num_bytes bytes of the block array.
+template<std::unsigned_integral Block>
+constexpr auto store_bytes(Block const* data, int n, std::byte* out, std::size_t num_bytes) noexcept
+{
+        auto const total = static_cast<std::size_t>(n) * sizeof(Block);
+        if constexpr (std::endian::native == std::endian::little) {
+                if (!std::is_constant_evaluated()) {
+                        return reverse_bytes(reinterpret_cast<unsigned char const*>(data) + total - num_bytes, num_bytes, reinterpret_cast<unsigned char*>(out));
+                }
+        }
+        for (auto i = std::size_t(0); i < static_cast<std::size_t>(n); ++i) {
+                auto bytes = std::bit_cast<std::array<std::byte, sizeof(Block)>>(data[static_cast<std::size_t>(n) - 1 - i]);
+                if constexpr (std::endian::native == std::endian::little) {
+                        std::ranges::reverse(bytes);
+                }
+                auto const offset = i * sizeof(Block);
+                std::copy_n(bytes.begin(), std::min(sizeof(Block), num_bytes - offset), out + offset);
+        }
+}
+
+// The inverse of store_bytes, with the bytes that are not stored set to zero.
+template<std::unsigned_integral Block>
+constexpr auto load_bytes(std::byte const* in, std::size_t num_bytes, Block* data, int n) noexcept
+{
+        auto const total = static_cast<std::size_t>(n) * sizeof(Block);
+        if constexpr (std::endian::native == std::endian::little) {
+                if (!std::is_constant_evaluated()) {
+                        auto const bytes = reinterpret_cast<unsigned char*>(data);
+                        std::fill_n(bytes, total - num_bytes, static_cast<unsigned char>(0));
+                        return reverse_bytes(reinterpret_cast<unsigned char const*>(in), num_bytes, bytes + total - num_bytes);
+                }
+        }
+        for (auto i = std::size_t(0); i < static_cast<std::size_t>(n); ++i) {
+                auto bytes = std::array<std::byte, sizeof(Block)>{};
+                auto const offset = i * sizeof(Block);
+                std::copy_n(in + offset, std::min(sizeof(Block), num_bytes - offset), bytes.begin());
+                if constexpr (std::endian::native == std::endian::little) {
+                        std::ranges::reverse(bytes);
+                }
+                data[static_cast<std::size_t>(n) - 1 - i] = std::bit_cast<Block>(bytes);
+        }
+}
+
+// In the string kernels, bit k of the multi-word integer data[n - 1] ... data[0] is bit k % digits of
+// data[k / digits]. On x86 this is bit k % 8 of byte k / 8 of the block array, so that the vectorized
+// kernels can move 32 or 64 consecutive bits to and from a movemask at any bit position.
+
+#if XSTD_BLOCK_KERNELS_X86
+
+// The width <= 64 bits of a mask are ORed into the bits at position p, where the bytes end at position end.
+inline auto or_bits(unsigned char* bytes, std::size_t p, std::uint64_t mask, int width, std::size_t end) noexcept
+{
+        auto const shift = static_cast<int>(p % 8);
+        auto const bits = static_cast<__uint128_t>(mask) << shift;
+        if (p / 8 + sizeof(bits) <= end) {
+                __uint128_t word;
+                std::memcpy(&word, bytes + p / 8, sizeof(word));
+                word |= bits;
+                std::memcpy(bytes + p / 8, &word, sizeof(word));
+                return;
+        }
+        for (auto j = 0; j < (shift + width + 7) / 8; ++j) {
+                bytes[p / 8 + static_cast<std::size_t>(j)] |= static_cast<unsigned char>(bits >> (8 * j));
+        }
+}
+
+// The width <= 64 bits at position p, where the bytes end at position end.
+[[nodiscard]] inline auto get_bits(unsigned char const* bytes, std::size_t p, int width, std::size_t end) noexcept
+        -> std::uint64_t
+{
+        auto const shift = static_cast<int>(p % 8);
+        auto bits = __uint128_t(0);
+        if (p / 8 + sizeof(bits) <= end) {
+                std::memcpy(&bits, bytes + p / 8, sizeof(bits));
+                return static_cast<std::uint64_t>(bits >> shift);
+        }
+        for (auto j = 0; j < (shift + width + 7) / 8 && p / 8 + static_cast<std::size_t>(j) < end; ++j) {
+                bits |= static_cast<__uint128_t>(bytes[p / 8 + static_cast<std::size_t>(j)]) << (8 * j);
+        }
+        return static_cast<std::uint64_t>(bits >> shift);
+}
+
+// Whether the 32 characters are all zeros or ones, with mask set to the ones.
+XSTD_TARGET_AVX2 inline auto parse_chars_avx2(char const* str, __m256i zeros, __m256i ones, std::uint64_t& mask) noexcept
+{
+        auto const v = _mm256_loadu_si256(vector_ptr<__m256i>(str));
+        auto const is_one = _mm256_cmpeq_epi8(v, ones);
+        mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(is_one));
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(is_one, _mm256_cmpeq_epi8(v, zeros)))) == 0xFFFF'FFFF;
+}
+
+// These return the number of characters done, and stop at the first invalid character.
+XSTD_TARGET_AVX2 inline auto parse_bits_avx2(char const* str, std::size_t len, char zero, char one, unsigned char* bytes, std::size_t offset, std::size_t end) noexcept
+        -> std::size_t
+{
+        auto const zeros = _mm256_set1_epi8(zero);
+        auto const ones = _mm256_set1_epi8(one);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= len; i += 64) {
+                // two vectors per iteration halve the overlapping writes of or_bits
+                std::uint64_t lo, hi;
+                if (!parse_chars_avx2(str + i, zeros, ones, lo) || !parse_chars_avx2(str + i + 32, zeros, ones, hi)) {
+                        return i;
+                }
+                or_bits(bytes, offset + i, lo | hi << 32, 64, end);
+        }
+        if (std::uint64_t mask; i + 32 <= len && parse_chars_avx2(str + i, zeros, ones, mask)) {
+                or_bits(bytes, offset + i, mask, 32, end);
+                i += 32;
+        }
+        return i;
+}
+
+XSTD_TARGET_AVX512 inline auto parse_bits_avx512(char const* str, std::size_t len, char zero, char one, unsigned char* bytes, std::size_t offset, std::size_t end) noexcept
+        -> std::size_t
+{
+        auto const zeros = _mm512_set1_epi8(zero);
+        auto const ones = _mm512_set1_epi8(one);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= len; i += 64) {
+                auto const v = _mm512_loadu_si512(str + i);
+                auto const is_one = _mm512_cmpeq_epi8_mask(v, ones);
+                if ((is_one | _mm512_cmpeq_epi8_mask(v, zeros)) != ~__mmask64(0)) {
+                        return i;
+                }
+                or_bits(bytes, offset + i, is_one, 64, end);
+        }
+        return i;
+}
+
+// Each byte of the mask is broadcast to 8 characters, whose own bit is then tested.
+XSTD_TARGET_AVX2 inline auto format_bits_avx2(unsigned char const* bytes, std::size_t offset, std::size_t end, char* str, std::size_t len, char zero, char one) noexcept
+        -> std::size_t
+{
+        auto const spread = _mm256_setr_epi8(
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+        );
+        auto const bit = _mm256_set1_epi64x(static_cast<long long>(0x8040'2010'0804'0201));
+        auto const zeros = _mm256_set1_epi8(zero);
+        auto const ones = _mm256_set1_epi8(one);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 32 <= len; i += 32) {
+                auto const mask = static_cast<int>(static_cast<std::uint32_t>(get_bits(bytes, offset + i, 32, end)));
+                auto const v = _mm256_shuffle_epi8(_mm256_set1_epi32(mask), spread);
+                auto const is_one = _mm256_cmpeq_epi8(_mm256_and_si256(v, bit), bit);
+                _mm256_storeu_si256(vector_ptr<__m256i>(str + i), _mm256_blendv_epi8(zeros, ones, is_one));
+        }
+        return i;
+}
+
+XSTD_TARGET_AVX512 inline auto format_bits_avx512(unsigned char const* bytes, std::size_t offset, std::size_t end, char* str, std::size_t len, char zero, char one) noexcept
+        -> std::size_t
+{
+        auto const zeros = _mm512_set1_epi8(zero);
+        auto const ones = _mm512_set1_epi8(one);
+        auto i = std::size_t(0);
+        for (/* init-statement before loop */; i + 64 <= len; i += 64) {
+                _mm512_storeu_si512(str + i, _mm512_mask_blend_epi8(get_bits(bytes, offset + i, 64, end), zeros, ones));
+        }
+        return i;
+}
+
+#endif
+
+// Sets bit offset + i of data, which has n blocks, for every 0 <= i < len with str[i] equal to one, and returns the
+// smallest i with str[i] equal to neither zero nor one, or len if there is none. The bits in
+// [offset, offset + len) must be zero on entry, and are only partially set if a character is invalid.
+template<class CharT, class Traits, std::unsigned_integral Block>
+constexpr auto parse_bits(CharT const* str, std::size_t len, CharT zero, CharT one, Block* data, int n [[maybe_unused]], std::size_t offset) noexcept
+        -> std::size_t
+{
+        constexpr auto block_size = static_cast<std::size_t>(std::numeric_limits<Block>::digits);
+        auto i = std::size_t(0);
+#if XSTD_BLOCK_KERNELS_X86
+        if constexpr (std::same_as<CharT, char> && std::same_as<Traits, std::char_traits<char>>) {
+                if (!std::is_constant_evaluated() && len >= min_vector_bytes) {
+                        auto const bytes = reinterpret_cast<unsigned char*>(data);
+                        auto const end = static_cast<std::size_t>(n) * sizeof(Block);
+                        if (auto const target = active_isa(); target == isa::avx512) {
+                                i = parse_bits_avx512(str, len, zero, one, bytes, offset, end);
+                        } else if (target == isa::avx2) {
+                                i = parse_bits_avx2(str, len, zero, one, bytes, offset, end);
+                        }
+                }
+        }
+#endif
+        for (/* init-statement before loop */; i < len; ++i) {
+                if (Traits::eq(str[i], one)) {
+                        auto const k = offset + i;
+                        data[k / block_size] |= static_cast<Block>(Block(1) << (k % block_size));
+                } else if (!Traits::eq(str[i], zero)) {
+                        return i;
+                }
+        }
+        return len;
+}
+
+// str[i] = (bit offset + i of data) ? one : zero for all 0 <= i < len, where data has n blocks.
+template<class CharT, class Traits, std::unsigned_integral Block>
+constexpr auto format_bits(Block const* data, int n [[maybe_unused]], std::size_t offset, CharT* str, std::size_t len, CharT zero, CharT one) noexcept
+{
+        constexpr auto block_size = static_cast<std::size_t>(std::numeric_limits<Block>::digits);
+        auto i = std::size_t(0);
+#if XSTD_BLOCK_KERNELS_X86
+        if constexpr (std::same_as<CharT, char> && std::same_as<Traits, std::char_traits<char>>) {
+                if (!std::is_constant_evaluated() && len >= min_vector_bytes) {
+                        auto const bytes = reinterpret_cast<unsigned char const*>(data);
+                        auto const end = static_cast<std::size_t>(n) * sizeof(Block);
+                        if (auto const target = active_isa(); target == isa::avx512) {
+                                i = format_bits_avx512(bytes, offset, end, str, len, zero, one);
+                        } else if (target == isa::avx2) {
+                                i = format_bits_avx2(bytes, offset, end, str, len, zero, one);
+                        }
+                }
+        }
+#endif
+        for (/* init-statement before loop */; i < len; ++i) {
+                auto const k = offset + i;
+                Traits::assign(str[i], (data[k / block_size] >> (k % block_size)) & 1 ? one : zero);
+        }
+}
+
+// Appends bits to an array of words, most significant bit first, so that for Word == Block the words
+// hold the bits of the bit_set layout in reverse block order. The last word is padded with low zero bits.
+template<std::unsigned_integral Word>
+class bit_packer
+{
+        static constexpr auto word_size = std::numeric_limits<Word>::digits;
+
+        Word* m_out;
+        Word m_word = 0;
+        int m_bits = 0;
+public:
+        [[nodiscard]] constexpr explicit bit_packer(Word* out) noexcept
+        :
+                m_out(out)
+        {}
+
+        constexpr auto push(bool bit) noexcept
+        {
+                m_word = static_cast<Word>(static_cast<Word>(m_word << 1) | static_cast<Word>(bit));
+                if (++m_bits == word_size) {
+                        *m_out++ = m_word;
+                        m_word = 0;
+                        m_bits = 0;
+                }
+        }
+
+        constexpr auto flush() noexcept
+        {
+                if (m_bits) {
+                        *m_out = static_cast<Word>(m_word << (word_size - m_bits));
+                }
+        }
+};
+
+// The batch kernels below take a query of n blocks and m candidates of n blocks each, the j-th of
+// which starts stride bytes after the (j - 1)-th one. The query stays in registers across all
+// candidates, and the vector kernels prefetch the candidate batch_prefetch_bytes ahead.
+inline constexpr auto batch_prefetch_bytes = std::size_t(1024);
+
+#if XSTD_BLOCK_KERNELS_X86
+
+inline auto prefetch_candidate(unsigned char const* c, std::size_t stride, std::size_t remaining) noexcept
+{
+        for (auto i = batch_prefetch_bytes; i < batch_prefetch_bytes + stride && i < remaining; i += 64) {
+                __builtin_prefetch(c + i);
+        }
+}
+
+template<std::size_t num_bytes>
+XSTD_TARGET_AVX512 inline auto load_batch_avx512(unsigned char const* c, std::size_t v) noexcept
+{
+        constexpr auto tail_bytes = num_bytes % 64;
+        if (tail_bytes && v == num_bytes / 64) {
+                return _mm512_maskz_loadu_epi8(static_cast<__mmask64>((~0ULL) >> (64 - tail_bytes)), c + 64 * v);
+        }
+        return _mm512_loadu_si512(c + 64 * v);
+}
+
+template<class Op, int n, std::unsigned_integral Block, std::unsigned_integral Word>
+XSTD_TARGET_AVX2 inline auto batch_any_avx2(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, Word* out) noexcept
+{
+        constexpr auto num_vectors = static_cast<std::size_t>(n) * sizeof(Block) / 32;
+        constexpr auto tail = static_cast<int>(num_vectors * 32 / sizeof(Block));
+        auto const q = reinterpret_cast<unsigned char const*>(query);
+        __m256i qv[num_vectors];
+        for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                qv[v] = _mm256_loadu_si256(vector_ptr<__m256i>(q + 32 * v));
+        }
+        auto packer = bit_packer<Word>(out);
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = candidates + j * stride;
+                prefetch_candidate(c, stride, (m - j) * stride);
+                auto acc = _mm256_setzero_si256();
+                for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                        acc = _mm256_or_si256(acc, Op::apply(qv[v], _mm256_loadu_si256(vector_ptr<__m256i>(c + 32 * v))));
+                }
+                auto any = !_mm256_testz_si256(acc, acc);
+                for (auto i = tail; i < n; ++i) {
+                        any |= Op::apply(query[i], reinterpret_cast<Block const*>(c)[i]) != 0;
+                }
+                packer.push(any);
+        }
+        packer.flush();
+}
+
+template<class Op, int n, std::unsigned_integral Block, std::unsigned_integral Word>
+XSTD_TARGET_AVX512 inline auto batch_any_avx512(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, Word* out) noexcept
+{
+        constexpr auto num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        constexpr auto num_vectors = (num_bytes + 63) / 64;
+        auto const q = reinterpret_cast<unsigned char const*>(query);
+        __m512i qv[num_vectors];
+        for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                qv[v] = load_batch_avx512<num_bytes>(q, v);
+        }
+        auto packer = bit_packer<Word>(out);
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = candidates + j * stride;
+                prefetch_candidate(c, stride, (m - j) * stride);
+                auto acc = _mm512_setzero_si512();
+                for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                        acc = _mm512_or_si512(acc, Op::apply(qv[v], load_batch_avx512<num_bytes>(c, v)));
+                }
+                packer.push(_mm512_test_epi64_mask(acc, acc) != 0);
+        }
+        packer.flush();
+}
+
+template<class Op, int n, std::unsigned_integral Block>
+XSTD_TARGET_AVX2 inline auto batch_count_avx2(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, std::size_t* out) noexcept
+{
+        constexpr auto num_vectors = static_cast<std::size_t>(n) * sizeof(Block) / 32;
+        constexpr auto tail = static_cast<int>(num_vectors * 32 / sizeof(Block));
+        auto const q = reinterpret_cast<unsigned char const*>(query);
+        __m256i qv[num_vectors];
+        for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                qv[v] = _mm256_loadu_si256(vector_ptr<__m256i>(q + 32 * v));
+        }
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = candidates + j * stride;
+                prefetch_candidate(c, stride, (m - j) * stride);
+                auto total = _mm256_setzero_si256();
+                for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                        total = _mm256_add_epi64(total, popcount_epi64(Op::apply(qv[v], _mm256_loadu_si256(vector_ptr<__m256i>(c + 32 * v)))));
+                }
+                auto sum = reduce_add_epi64(total);
+                for (auto i = tail; i < n; ++i) {
+                        sum += std::popcount(Op::apply(query[i], reinterpret_cast<Block const*>(c)[i]));
+                }
+                out[j] = static_cast<std::size_t>(sum);
+        }
+}
+
+template<class Op, int n, std::unsigned_integral Block>
+XSTD_TARGET_AVX512_VPOPCNTDQ inline auto batch_count_avx512_vpopcntdq(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, std::size_t* out) noexcept
+{
+        constexpr auto num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        constexpr auto num_vectors = (num_bytes + 63) / 64;
+        auto const q = reinterpret_cast<unsigned char const*>(query);
+        __m512i qv[num_vectors];
+        for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                qv[v] = load_batch_avx512<num_bytes>(q, v);
+        }
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = candidates + j * stride;
+                prefetch_candidate(c, stride, (m - j) * stride);
+                auto total = _mm512_setzero_si512();
+                for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(Op::apply(qv[v], load_batch_avx512<num_bytes>(c, v))));
+                }
+                out[j] = static_cast<std::size_t>(reduce_add_epi64(total));
+        }
+}
+
+template<class Op, int n, std::unsigned_integral Block>
+XSTD_TARGET_AVX512 inline auto batch_count_avx512(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, std::size_t* out) noexcept
+{
+        constexpr auto num_bytes = static_cast<std::size_t>(n) * sizeof(Block);
+        constexpr auto num_vectors = (num_bytes + 63) / 64;
+        auto const q = reinterpret_cast<unsigned char const*>(query);
+        __m512i qv[num_vectors];
+        for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                qv[v] = load_batch_avx512<num_bytes>(q, v);
+        }
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = candidates + j * stride;
+                prefetch_candidate(c, stride, (m - j) * stride);
+                auto total = _mm512_setzero_si512();
+                for (auto v = std::size_t(0); v < num_vectors; ++v) {
+                        total = _mm512_add_epi64(total, popcount_epi64(Op::apply(qv[v], load_batch_avx512<num_bytes>(c, v))));
+                }
+                out[j] = static_cast<std::size_t>(reduce_add_epi64(total));
+        }
+}
+
+#endif
+
+// Packs, for all 0 <= j < m, whether Op(query[i], candidate_j[i]) is nonzero for some 0 <= i < n into out.
+template<class Op, int n, std::unsigned_integral Block, std::unsigned_integral Word>
+inline auto batch_any(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, Word* out) noexcept
+{
+#if XSTD_BLOCK_KERNELS_X86
+        if constexpr (use_vector<Block>(n)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return batch_any_avx512<Op, n>(query, candidates, stride, m, out);
+                } else if (i == isa::avx2) {
+                        return batch_any_avx2<Op, n>(query, candidates, stride, m, out);
+                }
+        }
+#endif
+        auto packer = bit_packer<Word>(out);
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = reinterpret_cast<Block const*>(candidates + j * stride);
+                auto any = Block(0);
+                for (auto i = 0; i < n; ++i) {
+                        any |= Op::apply(query[i], c[i]);
+                }
+                packer.push(any != 0);
+        }
+        packer.flush();
+}
+
+// out[j] = the number of 1-bits in Op(query[i], candidate_j[i]) summed over all 0 <= i < n, for all 0 <= j < m
+template<class Op, int n, std::unsigned_integral Block>
+inline auto batch_count(Block const* query, unsigned char const* candidates, std::size_t stride, std::size_t m, std::size_t* out) noexcept
+{
+#if XSTD_BLOCK_KERNELS_X86
+        if constexpr (use_vector<Block>(n)) {
+                if (auto const i = active_isa(); i == isa::avx512) {
+                        return has_vpopcntdq() ? batch_count_avx512_vpopcntdq<Op, n>(query, candidates, stride, m, out) : batch_count_avx512<Op, n>(query, candidates, stride, m, out);
+                } else if (i == isa::avx2 && !has_popcnt) {
+                        return batch_count_avx2<Op, n>(query, candidates, stride, m, out);
+                }
+        }
+#endif
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const c = reinterpret_cast<Block const*>(candidates + j * stride);
+                auto sum = 0;
+                for (auto i = 0; i < n; ++i) {
+                        sum += std::popcount(Op::apply(query[i], c[i]));
+                }
+                out[j] = static_cast<std::size_t>(sum);
+        }
+}
+
+// Transposes in place the square bit matrix of block_size rows, whose i-th row is tile[i] with its
+// j-th column at bit block_size - 1 - j as in the bit_set layout, by swapping ever smaller
+// off-diagonal quadrants of all sub-matrices at once (Hacker's Delight, 2nd ed., section 7-3).
+template<std::unsigned_integral Block>
+constexpr auto transpose(Block* tile) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        auto mask = static_cast<Block>(static_cast<Block>(~Block(0)) >> (block_size / 2));
+        for (auto j = block_size / 2; j != 0; j >>= 1, mask = static_cast<Block>(mask ^ static_cast<Block>(mask << j))) {
+                for (auto k = 0; k < block_size; k = ((k | j) + 1) & ~j) {
+                        auto const t = static_cast<Block>((tile[k] ^ static_cast<Block>(tile[k | j] >> j)) & mask);
+                        tile[k] = static_cast<Block>(tile[k] ^ t);
+                        tile[k | j] = static_cast<Block>(tile[k | j] ^ static_cast<Block>(t << j));
+                }
+        }
+}
+
+// The bits of a block for the offsets in [first, last), with 0 <= first < last <= block_size,
+// where offset 0 is the most significant bit as in the bit_set layout.
+template<std::unsigned_integral Block>
+[[nodiscard]] constexpr auto range_mask(int first, int last) noexcept
+{
+        constexpr auto block_size = std::numeric_limits<Block>::digits;
+        constexpr auto ones = static_cast<Block>(~Block(0));
+        assert(0 <= first && first < last && last <= block_size);
+        return static_cast<Block>(static_cast<Block>(ones >> first) & static_cast<Block>(ones << (block_size - last)));
+}
+
+// Calls fun(block, mask) on the blocks of data, which holds the values in [0, size) in the bit_set
+// layout, that overlap [first, last) in ascending order of values, with mask selecting the values
+// in range, and stops as soon as fun returns false. Returns whether fun returned true for all blocks.
+template<class Block, class Fun>
+        requires std::unsigned_integral<std::remove_const_t<Block>>
+constexpr auto visit_range(Block* data, int size, int first, int last, Fun fun)
+        -> bool
+{
+        using block_type = std::remove_const_t<Block>;
+        constexpr auto block_size = std::numeric_limits<block_type>::digits;
+        constexpr auto ones = static_cast<block_type>(~block_type(0));
+        assert(0 <= first && first <= last && last <= size);
+        if (first == last) {
+                return true;
+        }
+        auto const last_block = (size - 1) / block_size;
+        auto const first_index = first / block_size, first_offset = first % block_size;
+        auto const last_index = (last - 1) / block_size, last_offset = (last - 1) % block_size;
+        if (first_index == last_index) {
+                return fun(data[last_block - first_index], range_mask<block_type>(first_offset, last_offset + 1));
+        }
+        if (!fun(data[last_block - first_index], range_mask<block_type>(first_offset, block_size))) {
+                return false;
+        }
+        for (auto i = last_block - first_index - 1; i > last_block - last_index; --i) {
+                if (!fun(data[i], ones)) {
+                        return false;
+                }
+        }
+        return fun(data[last_block - last_index], range_mask<block_type>(0, last_offset + 1));
+}
+
+// Adds the values in [first, last), each in [0, size), to data in the bit_set layout. Values are
+// collected in a register for as long as they fall into the same block, so that sorted input
+// costs one read-modify-write per block instead of one per value.
+template<std::unsigned_integral Block, class Iterator, class Sentinel>
+constexpr auto add_all(Block* data, int size, Iterator first, Sentinel last) noexcept
+{
+        constexpr auto block_size = static_cast<unsigned>(std::numeric_limits<Block>::digits);
+        constexpr auto last_bit = static_cast<Block>(Block(1) << (block_size - 1));
+        auto const last_block = (size - 1) / static_cast<int>(block_size);
+        while (first != last) {
+                auto const x = static_cast<int>(*first);
+                ++first;
+                assert(0 <= x && x < size);
+                auto const index = static_cast<unsigned>(x) / block_size;
+                auto bits = static_cast<Block>(last_bit >> (static_cast<unsigned>(x) % block_size));
+                for (/* init-statement before loop */; first != last; ++first) {
+                        auto const y = static_cast<int>(*first);
+                        assert(0 <= y && y < size);
+                        if (static_cast<unsigned>(y) / block_size != index) {
+                                break;
+                        }
+                        bits |= static_cast<Block>(last_bit >> (static_cast<unsigned>(y) % block_size));
+                }
+                data[last_block - static_cast<int>(index)] |= bits;
+        }
+}
+
+}       // namespace xstd::detail
+
+#endif  // include guard
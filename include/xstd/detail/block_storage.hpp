@@ -0,0 +1,228 @@
+#ifndef XSTD_DETAIL_BLOCK_STORAGE_HPP
+#define XSTD_DETAIL_BLOCK_STORAGE_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>    // copy, equal, swap_ranges
+#include <cassert>      // assert
+#include <concepts>     // unsigned_integral
+#include <cstddef>      // size_t
+#include <iterator>     // reverse_iterator
+#include <span>         // dynamic_extent, span
+#include <utility>      // exchange, swap
+
+namespace xstd::detail {
+
+// The fixed-size arrays of Size blocks that back an xstd::bit_set. All three are contiguous
+// ranges with data() and operator[], compare and swap by content, and differ only in ownership.
+
+// Blocks stored inside the object itself.
+template<std::unsigned_integral Block, std::size_t Size>
+class inline_blocks
+{
+        Block m_data[Size]{};   // zero-initialization
+public:
+        bool operator==(inline_blocks const&) const = default;
+
+        [[nodiscard]] constexpr auto data()        noexcept -> Block      * { return m_data; }
+        [[nodiscard]] constexpr auto data()  const noexcept -> Block const* { return m_data; }
+        [[nodiscard]] constexpr auto begin()       noexcept { return data(); }
+        [[nodiscard]] constexpr auto begin() const noexcept { return data(); }
+        [[nodiscard]] constexpr auto end()         noexcept { return data() + Size; }
+        [[nodiscard]] constexpr auto end()   const noexcept { return data() + Size; }
+
+        [[nodiscard]] constexpr auto& operator[](int i)       noexcept { return m_data[i]; }
+        [[nodiscard]] constexpr auto& operator[](int i) const noexcept { return m_data[i]; }
+
+        constexpr auto swap(inline_blocks& other) noexcept
+        {
+                std::ranges::swap_ranges(this->m_data, other.m_data);
+        }
+};
+
+// Blocks in an owned heap allocation. Moves transfer the allocation and leave a null pointer
+// behind, which reads as all zeros and is replaced by a fresh zeroed allocation on first write.
+template<std::unsigned_integral Block, std::size_t Size>
+class heap_blocks
+{
+        static inline Block s_zeros[Size]{};    // the blocks of a moved-from object, never written
+        Block* m_data = new Block[Size]{};      // zero-initialization
+public:
+        heap_blocks() = default;
+
+        [[nodiscard]] constexpr heap_blocks(heap_blocks const& other)
+        :
+                m_data(new Block[Size])
+        {
+                std::ranges::copy(other, m_data);
+        }
+
+        [[nodiscard]] constexpr heap_blocks(heap_blocks&& other) noexcept
+        :
+                m_data(std::exchange(other.m_data, nullptr))
+        {}
+
+        constexpr auto& operator=(heap_blocks const& other)
+        {
+                if (this != &other) {
+                        if (!m_data) {
+                                m_data = new Block[Size];
+                        }
+                        std::ranges::copy(other, m_data);
+                }
+                return *this;
+        }
+
+        constexpr auto& operator=(heap_blocks&& other) noexcept
+        {
+                std::swap(this->m_data, other.m_data);
+                return *this;
+        }
+
+        constexpr ~heap_blocks()
+        {
+                delete[] m_data;
+        }
+
+        [[nodiscard]] constexpr auto operator==(heap_blocks const& other) const noexcept
+                -> bool
+        {
+                return std::ranges::equal(*this, other);
+        }
+
+        [[nodiscard]] constexpr auto data() -> Block*
+        {
+                if (!m_data) {
+                        m_data = new Block[Size]{};
+                }
+                return m_data;
+        }
+
+        [[nodiscard]] constexpr auto data() const noexcept -> Block const*
+        {
+                return m_data ? m_data : s_zeros;
+        }
+
+        [[nodiscard]] constexpr auto begin()                { return data(); }
+        [[nodiscard]] constexpr auto begin() const noexcept { return data(); }
+        [[nodiscard]] constexpr auto end()                  { return data() + Size; }
+        [[nodiscard]] constexpr auto end()   const noexcept { return data() + Size; }
+
+        [[nodiscard]] constexpr auto& operator[](int i)                { return data()[i]; }
+        [[nodiscard]] constexpr auto& operator[](int i) const noexcept { return data()[i]; }
+
+        constexpr auto swap(heap_blocks& other) noexcept
+        {
+                std::swap(this->m_data, other.m_data);
+        }
+};
+
+// Blocks in a caller-owned buffer that must outlive this object. Assignment copies the
+// content into the buffer, and copy construction is deleted so that copies never share it
+// implicitly. Objects explicitly constructed over the same buffer do share it, and see each other's writes.
+template<std::unsigned_integral Block, std::size_t Size>
+class external_blocks
+{
+        Block* m_data;
+public:
+        [[nodiscard]] explicit constexpr external_blocks(std::span<Block, Size> buffer) noexcept
+        :
+                m_data(buffer.data())
+        {}
+
+        external_blocks(external_blocks const&) = delete;
+
+        constexpr auto& operator=(external_blocks const& other) noexcept
+        {
+                if (m_data != other.m_data) {
+                        std::ranges::copy(other, m_data);
+                }
+                return *this;
+        }
+
+        [[nodiscard]] constexpr auto operator==(external_blocks const& other) const noexcept
+                -> bool
+        {
+                return std::ranges::equal(*this, other);
+        }
+
+        [[nodiscard]] constexpr auto data()        noexcept -> Block      * { return m_data; }
+        [[nodiscard]] constexpr auto data()  const noexcept -> Block const* { return m_data; }
+        [[nodiscard]] constexpr auto begin()       noexcept { return data(); }
+        [[nodiscard]] constexpr auto begin() const noexcept { return data(); }
+        [[nodiscard]] constexpr auto end()         noexcept { return data() + Size; }
+        [[nodiscard]] constexpr auto end()   const noexcept { return data() + Size; }
+
+        [[nodiscard]] constexpr auto& operator[](int i)       noexcept { return data()[i]; }
+        [[nodiscard]] constexpr auto& operator[](int i) const noexcept { return data()[i]; }
+
+        constexpr auto swap(external_blocks& other) noexcept
+        {
+                if (m_data != other.m_data) {
+                        std::ranges::swap_ranges(*this, other);
+                }
+        }
+};
+
+// Blocks in a caller-owned buffer of runtime length, which backs an xstd::dynamic_bit_set
+// that is a view (see xstd::bit_span). As for a fixed Size, assignment and swap copy the content,
+// and they require buffers of equal length.
+template<std::unsigned_integral Block>
+class external_blocks<Block, std::dynamic_extent>
+{
+        std::span<Block> m_data;
+public:
+        [[nodiscard]] explicit constexpr external_blocks(std::span<Block> buffer) noexcept
+        :
+                m_data(buffer)
+        {}
+
+        external_blocks(external_blocks const&) = delete;
+
+        constexpr auto& operator=(external_blocks const& other) noexcept
+        {
+                assert(this->size() == other.size());
+                if (data() != other.data()) {
+                        std::ranges::copy(other, data());
+                }
+                return *this;
+        }
+
+        [[nodiscard]] constexpr auto operator==(external_blocks const& other) const noexcept
+                -> bool
+        {
+                return std::ranges::equal(*this, other);
+        }
+
+        [[nodiscard]] constexpr auto data()        noexcept -> Block      * { return m_data.data(); }
+        [[nodiscard]] constexpr auto data()  const noexcept -> Block const* { return m_data.data(); }
+        [[nodiscard]] constexpr auto begin()       noexcept { return data(); }
+        [[nodiscard]] constexpr auto begin() const noexcept { return data(); }
+        [[nodiscard]] constexpr auto end()         noexcept { return data() + size(); }
+        [[nodiscard]] constexpr auto end()   const noexcept { return data() + size(); }
+        [[nodiscard]] constexpr auto rbegin()      noexcept { return std::reverse_iterator(end());   }
+        [[nodiscard]] constexpr auto rbegin() const noexcept { return std::reverse_iterator(end());   }
+        [[nodiscard]] constexpr auto rend()        noexcept { return std::reverse_iterator(begin()); }
+        [[nodiscard]] constexpr auto rend()  const noexcept { return std::reverse_iterator(begin()); }
+
+        [[nodiscard]] constexpr auto size()  const noexcept { return m_data.size();  }
+        [[nodiscard]] constexpr auto empty() const noexcept { return m_data.empty(); }
+
+        [[nodiscard]] constexpr auto& operator[](std::size_t i)       noexcept { return data()[i]; }
+        [[nodiscard]] constexpr auto& operator[](std::size_t i) const noexcept { return data()[i]; }
+
+        constexpr auto swap(external_blocks& other) noexcept
+        {
+                assert(this->size() == other.size());
+                if (data() != other.data()) {
+                        std::ranges::swap_ranges(*this, other);
+                }
+        }
+};
+
+}       // namespace xstd::detail
+
+#endif  // include guard
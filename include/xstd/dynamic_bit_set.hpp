@@ -0,0 +1,1196 @@
+#ifndef XSTD_DYNAMIC_BIT_SET_HPP
+#define XSTD_DYNAMIC_BIT_SET_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/detail/block_kernels.hpp> // bit_and, bit_minus, bit_or, bit_xor, count, decode, first_nonzero, last_nonzero, load_bytes, popcount, shift_left, shift_right, store_bytes, transform
+#include <xstd/detail/block_storage.hpp> // external_blocks
+#include <algorithm>                     // fill_n, lexicographical_compare_three_way, shift_left, shift_right
+#include <bit>                           // countl_zero, countr_zero, has_single_bit, popcount
+#include <cassert>                       // assert
+#include <compare>                       // strong_ordering
+#include <concepts>                      // constructible_from, input_iterator, same_as, unsigned_integral
+#include <cstddef>                       // byte, ptrdiff_t, size_t
+#include <functional>                    // identity, less
+#include <initializer_list>              // initializer_list
+#include <iterator>                      // bidirectional_iterator_tag, reverse_iterator
+#include <limits>                        // digits, max
+#include <memory>                        // allocator
+#include <ranges>                        // all_of, begin, end, equal, fill, none_of, range, views::drop
+#include <span>                          // dynamic_extent, span
+#include <stdexcept>                     // length_error
+#include <type_traits>                   // common_type_t, conditional_t, is_class_v, make_signed_t
+#include <utility>                       // exchange, forward, move, pair, swap
+#include <vector>                        // vector
+
+namespace xstd {
+
+namespace detail {
+
+struct dynamic_bit_set_access;
+
+}       // namespace detail
+
+// A runtime-sized ordered set of int with the interface of xstd::bit_set<N, Block>, where N is
+// the max_size() given at construction or by resize(). The blocks are laid out as for bit_set,
+// so that both containers share the same block kernels. Binary operations and set predicates
+// require both operands to have the same max_size().
+//
+// The blocks are held in Storage, which is either the default std::vector or, for a view over
+// a caller-owned buffer, detail::external_blocks<Block, std::dynamic_extent>. Such a view is
+// neither copy-constructible nor resizable, and its assignments copy into the buffer.
+template<std::unsigned_integral Block = std::size_t, class Allocator = std::allocator<Block>, class Storage = std::vector<Block, Allocator>>
+class dynamic_bit_set
+{
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto is_view = std::same_as<Storage, detail::external_blocks<Block, std::dynamic_extent>>;
+
+        template<bool> class proxy_reference;
+        template<bool> class proxy_iterator;
+
+        using const_proxy_reference = proxy_reference<true>;
+        using const_proxy_iterator = proxy_iterator<true>;
+
+        Storage m_data;
+        int m_size = 0;                         // keep size_t from spilling all over the code base
+
+        friend struct detail::dynamic_bit_set_access;
+
+        template<std::unsigned_integral, class, class>
+        friend class dynamic_bit_set;
+public:
+        using key_type               = int;
+        using key_compare            = std::less<key_type>;
+        using value_type             = int;
+        using value_compare          = std::less<value_type>;
+        using allocator_type         = Allocator;
+        using pointer                = const_proxy_iterator;
+        using const_pointer          = const_proxy_iterator;
+        using reference              = const_proxy_reference;
+        using const_reference        = const_proxy_reference;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using iterator               = const_proxy_iterator;
+        using const_iterator         = const_proxy_iterator;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using block_type             = Block;
+
+        dynamic_bit_set() = default;            // max_size() == 0
+
+        [[nodiscard]] explicit constexpr dynamic_bit_set(allocator_type const& alloc) noexcept
+                requires (!is_view)
+        :
+                m_data(alloc)
+        {}
+
+        [[nodiscard]] explicit constexpr dynamic_bit_set(size_type n, allocator_type const& alloc = allocator_type())
+                requires (!is_view)
+        :
+                m_data(static_cast<std::size_t>(blocks_for(checked_size(n))), zero, alloc),
+                m_size(static_cast<int>(n))
+        {}
+
+        // Adopts the contents of the first num_blocks(n) blocks of buffer, whose unused bits must
+        // be zero, as the blocks of a view with max_size() == n. The buffer must outlive the view.
+        [[nodiscard]] constexpr dynamic_bit_set(size_type n, std::span<Block> buffer)
+                requires is_view
+        :
+                m_data(buffer.first(num_blocks(n))),
+                m_size(static_cast<int>(n))
+        {
+                assert(m_data.empty() || !(m_data[0] & static_cast<block_type>(~used_bits())));
+        }
+
+        template<class InputIterator>
+        [[nodiscard]] constexpr dynamic_bit_set(size_type n, InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
+                requires (!is_view && std::input_iterator<InputIterator>)
+        :
+                dynamic_bit_set(n, alloc)
+        {
+                insert(first, last);
+        }
+
+        [[nodiscard]] constexpr dynamic_bit_set(size_type n, std::initializer_list<value_type> ilist, allocator_type const& alloc = allocator_type())
+                requires (!is_view)
+        :
+                dynamic_bit_set(n, ilist.begin(), ilist.end(), alloc)
+        {}
+
+        dynamic_bit_set(dynamic_bit_set const&) = default;
+
+        [[nodiscard]] constexpr dynamic_bit_set(dynamic_bit_set const& other, allocator_type const& alloc)
+                requires (!is_view)
+        :
+                m_data(other.m_data, alloc),
+                m_size(other.m_size)
+        {}
+
+        // A moved-from set is left empty with max_size() == 0.
+        [[nodiscard]] constexpr dynamic_bit_set(dynamic_bit_set&& other) noexcept
+                requires (!is_view)
+        :
+                m_data(std::move(other.m_data)),
+                m_size(std::exchange(other.m_size, 0))
+        {
+                other.m_data.clear();
+        }
+
+        [[nodiscard]] constexpr dynamic_bit_set(dynamic_bit_set&& other, allocator_type const& alloc)
+                requires (!is_view)
+        :
+                m_data(std::move(other.m_data), alloc),
+                m_size(std::exchange(other.m_size, 0))
+        {
+                other.m_data.clear();
+        }
+
+        dynamic_bit_set& operator=(dynamic_bit_set const&) = default;
+
+        constexpr auto& operator=(dynamic_bit_set&& other) noexcept(
+                std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                std::allocator_traits<Allocator>::is_always_equal::value
+        )
+                requires (!is_view)
+        {
+                if (this != &other) {
+                        m_data = std::move(other.m_data);
+                        m_size = std::exchange(other.m_size, 0);
+                        other.m_data.clear();
+                }
+                return *this;
+        }
+
+        constexpr auto& operator=(std::initializer_list<value_type> ilist) noexcept
+        {
+                clear();
+                insert(ilist.begin(), ilist.end());
+                return *this;
+        }
+
+        ~dynamic_bit_set() = default;
+
+        [[nodiscard]] constexpr auto get_allocator() const noexcept
+                requires (!is_view)
+        {
+                return m_data.get_allocator();
+        }
+
+        bool operator==(dynamic_bit_set const&) const = default;
+
+        // Sets with a different Storage, e.g. an owning set and a view, compare, combine and count
+        // as if they had the same one.
+        template<class OtherAllocator, class OtherStorage>
+                requires (!std::same_as<dynamic_bit_set<Block, OtherAllocator, OtherStorage>, dynamic_bit_set>)
+        [[nodiscard]] constexpr auto operator==(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) const noexcept
+                -> bool
+        {
+                return this->m_size == other.m_size && std::ranges::equal(this->m_data, other.m_data);
+        }
+
+        // Sets of the same max_size() are ordered as bit_set<N> would order them.
+        template<class OtherAllocator, class OtherStorage>
+        [[nodiscard]] constexpr auto operator<=>(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) const noexcept
+                -> std::strong_ordering
+        {
+                if (auto const cmp = std::lexicographical_compare_three_way(
+                        other.m_data.rbegin(), other.m_data.rend(),
+                        this->m_data.rbegin(), this->m_data.rend()
+                ); cmp != 0) {
+                        return cmp;
+                }
+                return this->m_size <=> other.m_size;
+        }
+
+        [[nodiscard]] constexpr auto begin()         noexcept { return       iterator(this, find_first()); }
+        [[nodiscard]] constexpr auto begin()   const noexcept { return const_iterator(this, find_first()); }
+        [[nodiscard]] constexpr auto end()           noexcept { return       iterator(this, m_size); }
+        [[nodiscard]] constexpr auto end()     const noexcept { return const_iterator(this, m_size); }
+
+        [[nodiscard]] constexpr auto rbegin()        noexcept { return       reverse_iterator(end()); }
+        [[nodiscard]] constexpr auto rbegin()  const noexcept { return const_reverse_iterator(end()); }
+        [[nodiscard]] constexpr auto rend()          noexcept { return       reverse_iterator(begin()); }
+        [[nodiscard]] constexpr auto rend()    const noexcept { return const_reverse_iterator(begin()); }
+
+        [[nodiscard]] constexpr auto cbegin()  const noexcept { return const_iterator(begin()); }
+        [[nodiscard]] constexpr auto cend()    const noexcept { return const_iterator(end());   }
+        [[nodiscard]] constexpr auto crbegin() const noexcept { return const_reverse_iterator(rbegin()); }
+        [[nodiscard]] constexpr auto crend()   const noexcept { return const_reverse_iterator(rend());   }
+
+        [[nodiscard]] constexpr auto front() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return { *this, find_front() };
+        }
+
+        [[nodiscard]] constexpr auto back() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return { *this, find_back() };
+        }
+
+        [[nodiscard]] constexpr auto empty() const noexcept
+        {
+                return std::ranges::none_of(m_data, std::identity{});
+        }
+
+        [[nodiscard]] constexpr auto full() const noexcept
+        {
+                return m_data.empty() || (m_data[0] == used_bits() && std::ranges::all_of(m_data | std::views::drop(1), [](auto block) {
+                        return block == ones;
+                }));
+        }
+
+        [[nodiscard]] constexpr auto ssize() const noexcept
+        {
+                return detail::popcount(m_data.data(), num_logical_blocks());
+        }
+
+        [[nodiscard]] constexpr auto size() const noexcept
+        {
+                return static_cast<size_type>(ssize());
+        }
+
+        [[nodiscard]] constexpr auto max_size() const noexcept
+        {
+                return static_cast<size_type>(m_size);
+        }
+
+        // The number of blocks of a set with max_size() == n, e.g. of the buffer of a view.
+        [[nodiscard]] static constexpr auto num_blocks(size_type n)
+                -> size_type
+        {
+                return static_cast<size_type>(blocks_for(checked_size(n)));
+        }
+
+        // The largest max_size() that resize() can reach without reallocating.
+        [[nodiscard]] constexpr auto capacity() const noexcept
+                -> size_type
+                requires (!is_view)
+        {
+                return m_data.capacity() * static_cast<size_type>(block_size);
+        }
+
+        constexpr auto reserve(size_type n)
+                requires (!is_view)
+        {
+                m_data.reserve(static_cast<std::size_t>(blocks_for(checked_size(n))));
+        }
+
+        constexpr auto shrink_to_fit()
+                requires (!is_view)
+        {
+                m_data.shrink_to_fit();
+        }
+
+        // Sets max_size() to n and erases all elements that are not less than n. The blocks are
+        // moved within the current storage, which is only reallocated if n exceeds capacity().
+        constexpr auto resize(size_type n)
+                requires (!is_view)
+        {
+                auto const M = checked_size(n);
+                auto const old_blocks = num_logical_blocks();
+                auto const new_blocks = blocks_for(M);
+                if (new_blocks > old_blocks) {
+                        m_data.resize(static_cast<std::size_t>(new_blocks));
+                        std::shift_right(m_data.begin(), m_data.end(), new_blocks - old_blocks);
+                        std::fill_n(m_data.begin(), new_blocks - old_blocks, zero);
+                } else if (new_blocks < old_blocks) {
+                        std::shift_left(m_data.begin(), m_data.end(), old_blocks - new_blocks);
+                        m_data.resize(static_cast<std::size_t>(new_blocks));
+                }
+                m_size = M;
+                clear_unused_bits();
+        }
+
+        template<class... Args>
+        constexpr auto emplace(Args&&... args) noexcept
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        template<class... Args>
+        constexpr auto emplace_hint(const_iterator hint, Args&&... args) noexcept
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(hint, value_type(std::forward<Args>(args)...));
+        }
+
+        constexpr auto add(value_type x) noexcept
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                block |= mask;
+                assert(contains(x));
+        }
+
+private:
+        constexpr auto do_insert(value_type x) noexcept
+                -> std::pair<iterator, bool>
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                auto const inserted = !(block & mask);
+                block |= mask;
+                assert(contains(x));
+                return { { this, x },  inserted };
+        }
+
+public:
+        constexpr auto insert(value_type const& x) noexcept
+        {
+                return do_insert(x);
+        }
+
+        constexpr auto insert(value_type&& x) noexcept
+        {
+                return do_insert(std::move(x));
+        }
+
+private:
+        constexpr auto do_insert(const_iterator /* hint */, value_type x) noexcept
+                -> iterator
+        {
+                add(x);
+                return { this, x };
+        }
+
+public:
+        constexpr auto insert(const_iterator hint, value_type const& x) noexcept
+        {
+                return do_insert(hint, x);
+        }
+
+        constexpr auto insert(const_iterator hint, value_type&& x) noexcept
+        {
+                return do_insert(hint, std::move(x));
+        }
+
+        template<class InputIterator>
+        constexpr auto insert(InputIterator first, InputIterator last) noexcept
+                requires std::input_iterator<InputIterator> && std::constructible_from<value_type, decltype(*first)>
+        {
+                detail::add_all(m_data.data(), m_size, first, last);
+        }
+
+        template<class Range>
+        constexpr auto insert_range(Range&& rg) noexcept
+                requires std::ranges::range<Range> && std::constructible_from<value_type, decltype(*rg.begin())>
+        {
+                detail::add_all(m_data.data(), m_size, std::ranges::begin(rg), std::ranges::end(rg));
+        }
+
+        constexpr auto insert(std::initializer_list<value_type> ilist) noexcept
+        {
+                insert(ilist.begin(), ilist.end());
+        }
+
+        // Inserts all values in [first, last).
+        constexpr auto insert(value_type first, value_type last) noexcept
+        {
+                detail::visit_range(m_data.data(), m_size, first, last, [](auto& block, auto mask) {
+                        block |= mask;
+                        return true;
+                });
+        }
+
+        constexpr auto fill() noexcept
+        {
+                std::ranges::fill(m_data, ones);
+                clear_unused_bits();
+                assert(full());
+        }
+
+        constexpr auto pop(key_type x) noexcept
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                block &= static_cast<block_type>(~mask);
+                assert(!contains(x));
+        }
+
+        constexpr auto erase(key_type const& x) noexcept
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                auto const erased = static_cast<size_type>(static_cast<bool>(block & mask));
+                block &= static_cast<block_type>(~mask);
+                assert(!contains(x));
+                return erased;
+        }
+
+        constexpr auto erase(const_iterator pos) noexcept
+        {
+                assert(pos != end());
+                pop(*pos++);
+                return pos;
+        }
+
+        constexpr auto erase(const_iterator first, const_iterator last) noexcept
+        {
+                erase(first == cend() ? m_size : *first, last == cend() ? m_size : *last);
+                return last;
+        }
+
+        // Erases all values in [first, last).
+        constexpr auto erase(value_type first, value_type last) noexcept
+        {
+                detail::visit_range(m_data.data(), m_size, first, last, [](auto& block, auto mask) {
+                        block &= static_cast<block_type>(~mask);
+                        return true;
+                });
+        }
+
+        // Views swap the contents of their buffers, and require equal max_size().
+        constexpr auto swap(dynamic_bit_set& other) noexcept
+        {
+                this->m_data.swap(other.m_data);
+                std::swap(this->m_size, other.m_size);
+        }
+
+        constexpr auto clear() noexcept
+        {
+                std::ranges::fill(m_data, zero);
+                assert(empty());
+        }
+
+        constexpr auto replace(value_type x) noexcept
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                block ^= mask;
+        }
+
+        [[nodiscard]] constexpr auto find(key_type const& x) noexcept
+        {
+                assert(is_valid(x));
+                return contains(x) ? iterator(this, x) : end();
+        }
+
+        [[nodiscard]] constexpr auto find(key_type const& x) const noexcept
+        {
+                assert(is_valid(x));
+                return contains(x) ? const_iterator(this, x) : cend();
+        }
+
+        [[nodiscard]] constexpr auto count(key_type const& x) const noexcept
+                -> size_type
+        {
+                assert(is_valid(x));
+                return contains(x);
+        }
+
+        [[nodiscard]] constexpr auto contains(key_type const& x) const noexcept
+                -> bool
+        {
+                assert(is_valid(x));
+                auto&& [ block, mask ] = block_mask(x);
+                return block & mask;
+        }
+
+        // The number of elements in [first, last).
+        [[nodiscard]] constexpr auto count(value_type first, value_type last) const noexcept
+                -> size_type
+        {
+                auto n = 0;
+                detail::visit_range(m_data.data(), m_size, first, last, [&](auto block, auto mask) {
+                        n += std::popcount(static_cast<block_type>(block & mask));
+                        return true;
+                });
+                return static_cast<size_type>(n);
+        }
+
+        // Whether any value in [first, last) is an element.
+        [[nodiscard]] constexpr auto contains_any(value_type first, value_type last) const noexcept
+                -> bool
+        {
+                return !detail::visit_range(m_data.data(), m_size, first, last, [](auto block, auto mask) {
+                        return !(block & mask);
+                });
+        }
+
+        // Whether all values in [first, last) are elements.
+        [[nodiscard]] constexpr auto contains_all(value_type first, value_type last) const noexcept
+                -> bool
+        {
+                return detail::visit_range(m_data.data(), m_size, first, last, [](auto block, auto mask) {
+                        return (block & mask) == mask;
+                });
+        }
+
+        [[nodiscard]] constexpr auto lower_bound(key_type const& x) noexcept
+                -> iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x) };
+        }
+
+        [[nodiscard]] constexpr auto lower_bound(key_type const& x) const noexcept
+                -> const_iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x) };
+        }
+
+        [[nodiscard]] constexpr auto upper_bound(key_type const& x) noexcept
+                -> iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x + 1) };
+        }
+
+        [[nodiscard]] constexpr auto upper_bound(key_type const& x) const noexcept
+                -> const_iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x + 1) };
+        }
+
+        [[nodiscard]] constexpr auto equal_range(key_type const& x) noexcept
+                -> std::pair<iterator, iterator>
+        {
+                assert(is_valid(x));
+                return { lower_bound(x), upper_bound(x) };
+        }
+
+        [[nodiscard]] constexpr auto equal_range(key_type const& x) const noexcept
+                -> std::pair<const_iterator, const_iterator>
+        {
+                assert(is_valid(x));
+                return { lower_bound(x), upper_bound(x) };
+        }
+
+        constexpr auto& complement() noexcept
+        {
+                for (auto& block : m_data) {
+                        block = static_cast<block_type>(~block);
+                }
+                clear_unused_bits();
+                return *this;
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        constexpr auto& operator&=(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) noexcept
+        {
+                assert(this->m_size == other.m_size);
+                detail::transform<detail::bit_and>(this->m_data.data(), other.m_data.data(), num_logical_blocks());
+                return *this;
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        constexpr auto& operator|=(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) noexcept
+        {
+                assert(this->m_size == other.m_size);
+                detail::transform<detail::bit_or>(this->m_data.data(), other.m_data.data(), num_logical_blocks());
+                return *this;
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        constexpr auto& operator^=(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) noexcept
+        {
+                assert(this->m_size == other.m_size);
+                detail::transform<detail::bit_xor>(this->m_data.data(), other.m_data.data(), num_logical_blocks());
+                return *this;
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        constexpr auto& operator-=(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) noexcept
+        {
+                assert(this->m_size == other.m_size);
+                detail::transform<detail::bit_minus>(this->m_data.data(), other.m_data.data(), num_logical_blocks());
+                return *this;
+        }
+
+        constexpr auto& operator<<=(value_type n) noexcept
+        {
+                assert(is_valid(n));
+                detail::shift_right(m_data.data(), num_logical_blocks(), n);
+                clear_unused_bits();
+                return *this;
+        }
+
+        constexpr auto& operator>>=(value_type n) noexcept
+        {
+                assert(is_valid(n));
+                detail::shift_left(m_data.data(), num_logical_blocks(), n);
+                return *this;
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        [[nodiscard]] constexpr auto is_subset_of(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) const noexcept
+        {
+                assert(this->m_size == other.m_size);
+                return std::ranges::equal(this->m_data, other.m_data, [](auto lhs, auto rhs) {
+                        return !(lhs & ~rhs);
+                });
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        [[nodiscard]] constexpr auto is_proper_subset_of(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) const noexcept
+        {
+                assert(this->m_size == other.m_size);
+                auto const this_data = this->m_data.data();
+                auto const other_data = other.m_data.data();
+                auto const n = num_logical_blocks();
+                auto i = 0;
+                for (/* init-statement before loop */; i < n; ++i) {
+                        if (this_data[i] & ~other_data[i]) {
+                                return false;
+                        }
+                        if (other_data[i] & ~this_data[i]) {
+                                break;
+                        }
+                }
+                return (i == n) ? false : std::ranges::equal(
+                        this_data + i, this_data + n, other_data + i, other_data + n,
+                        [](auto lhs, auto rhs) {
+                                return !(lhs & ~rhs);
+                        }
+                );
+        }
+
+        template<class OtherAllocator, class OtherStorage>
+        [[nodiscard]] constexpr auto intersects(dynamic_bit_set<Block, OtherAllocator, OtherStorage> const& other) const noexcept
+                -> bool
+        {
+                assert(this->m_size == other.m_size);
+                return !std::ranges::equal(this->m_data, other.m_data, [](auto lhs, auto rhs) {
+                        return !(lhs & rhs);
+                });
+        }
+
+        // See bit_set::for_each.
+        template<class UnaryFunction>
+        constexpr auto for_each(UnaryFunction fun) const
+        {
+                auto const data = m_data.data();
+                for (auto i = detail::last_nonzero(data, num_logical_blocks()); i >= 0; i = detail::last_nonzero(data, i)) {
+                        auto const base = (last_block() - i) * block_size;
+                        auto block = data[i];
+                        while (block) {
+                                auto const offset = std::countl_zero(block);
+                                fun(base + offset);
+                                block ^= static_cast<block_type>(last_bit >> offset);
+                        }
+                }
+                return fun;
+        }
+
+        // See bit_set::decode.
+        constexpr auto decode(std::span<value_type> out [[maybe_unused]]) const noexcept
+                -> size_type
+        {
+                assert(out.size() >= size());
+                return static_cast<size_type>(detail::decode(m_data.data(), num_logical_blocks(), out.data()));
+        }
+
+        [[nodiscard]] constexpr auto to_vector() const
+                -> std::vector<value_type>
+        {
+                std::vector<value_type> nrv(size());
+                decode(nrv);
+                return nrv;
+        }
+
+        // See bit_set::num_bytes.
+        [[nodiscard]] constexpr auto num_bytes() const noexcept
+                -> size_type
+        {
+                return (max_size() + 7) / 8;
+        }
+
+        // See bit_set::to_bytes. The representation only depends on the elements and max_size().
+        constexpr auto to_bytes(std::span<std::byte> out) const noexcept
+        {
+                assert(out.size() == num_bytes());
+                detail::store_bytes(m_data.data(), num_logical_blocks(), out.data(), num_bytes());
+        }
+
+        [[nodiscard]] constexpr auto to_bytes() const
+                -> std::vector<std::byte>
+        {
+                std::vector<std::byte> nrv(num_bytes());
+                to_bytes(nrv);
+                return nrv;
+        }
+
+        // See bit_set::from_bytes. The max_size() is kept.
+        constexpr auto from_bytes(std::span<std::byte const> in) noexcept
+        {
+                assert(in.size() == num_bytes());
+                detail::load_bytes(in.data(), num_bytes(), m_data.data(), num_logical_blocks());
+                assert(m_data.empty() || !(m_data[0] & static_cast<block_type>(~used_bits())));
+        }
+
+private:
+        static constexpr auto zero = static_cast<block_type>( 0);
+        static constexpr auto ones = static_cast<block_type>(-1);
+        static constexpr auto last_bit = static_cast<block_type>(static_cast<block_type>(1) << (block_size - 1));
+        static_assert(std::has_single_bit(last_bit));
+
+        // As for std::vector, a max_size() that the container cannot represent throws.
+        [[nodiscard]] static constexpr auto checked_size(size_type n)
+        {
+                if (n > static_cast<size_type>(std::numeric_limits<int>::max())) {
+                        throw std::length_error("xstd::dynamic_bit_set: max_size() exceeds INT_MAX");
+                }
+                return static_cast<int>(n);
+        }
+
+        [[nodiscard]] static constexpr auto blocks_for(int M) noexcept
+        {
+                return (M - 1 + block_size) / block_size;
+        }
+
+        [[nodiscard]] constexpr auto num_logical_blocks() const noexcept
+        {
+                return static_cast<int>(m_data.size());
+        }
+
+        [[nodiscard]] constexpr auto last_block() const noexcept
+        {
+                return num_logical_blocks() - 1;
+        }
+
+        [[nodiscard]] constexpr auto num_bits() const noexcept
+        {
+                return num_logical_blocks() * block_size;
+        }
+
+        [[nodiscard]] constexpr auto used_bits() const noexcept
+        {
+                return static_cast<block_type>(ones << (num_bits() - m_size));
+        }
+
+        [[nodiscard]] constexpr auto is_valid(value_type n) const noexcept
+        {
+                return 0 <= n && n < m_size;
+        }
+
+        [[nodiscard]] constexpr auto in_range(value_type n) const noexcept
+        {
+                return 0 <= n && n <= m_size;
+        }
+
+        [[nodiscard]] static constexpr auto div(value_type numer, value_type denom) noexcept
+                -> std::pair<value_type, value_type>
+        {
+                return { numer / denom, numer % denom };
+        }
+
+        [[nodiscard]] constexpr auto block_mask(value_type n) noexcept
+                -> std::pair<block_type&, block_type>
+        {
+                assert(is_valid(n));
+                auto const [ index, offset ] = div(n, block_size);
+                return { m_data[static_cast<std::size_t>(last_block() - index)], static_cast<block_type>(last_bit >> offset) };
+        }
+
+        [[nodiscard]] constexpr auto block_mask(value_type n) const noexcept
+                -> std::pair<block_type const&, block_type>
+        {
+                assert(is_valid(n));
+                auto const [ index, offset ] = div(n, block_size);
+                return { m_data[static_cast<std::size_t>(last_block() - index)], static_cast<block_type>(last_bit >> offset) };
+        }
+
+        constexpr auto clear_unused_bits() noexcept
+        {
+                if (!m_data.empty()) {
+                        m_data[0] &= used_bits();
+                }
+        }
+
+        [[nodiscard]] constexpr auto find_front() const noexcept
+        {
+                assert(!empty());
+                auto const i = detail::last_nonzero(m_data.data(), num_logical_blocks());
+                return (last_block() - i) * block_size + std::countl_zero(m_data[static_cast<std::size_t>(i)]);
+        }
+
+        [[nodiscard]] constexpr auto find_back() const noexcept
+        {
+                assert(!empty());
+                auto const i = detail::first_nonzero(m_data.data(), num_logical_blocks());
+                return num_bits() - 1 - i * block_size - std::countr_zero(m_data[static_cast<std::size_t>(i)]);
+        }
+
+        [[nodiscard]] constexpr auto find_first() const noexcept
+        {
+                if (auto const i = detail::last_nonzero(m_data.data(), num_logical_blocks()); i >= 0) {
+                        return (last_block() - i) * block_size + std::countl_zero(m_data[static_cast<std::size_t>(i)]);
+                }
+                return m_size;
+        }
+
+        [[nodiscard]] constexpr auto find_next(value_type n) const noexcept
+        {
+                assert(in_range(n));
+                if (n == m_size) {
+                        return m_size;
+                }
+                auto const data = m_data.data();
+                auto const [ index, offset ] = div(n, block_size);
+                auto i = last_block() - index;
+                if (offset) {
+                        if (auto const block = static_cast<block_type>(data[i] << offset); block) {
+                                return n + std::countl_zero(block);
+                        }
+                        --i;
+                        n += block_size - offset;
+                }
+                if (auto const j = detail::last_nonzero(data, i + 1); j >= 0) {
+                        return n + (i - j) * block_size + std::countl_zero(data[j]);
+                }
+                return m_size;
+        }
+
+        [[nodiscard]] constexpr auto find_prev(value_type n) const noexcept
+        {
+                assert(is_valid(n));
+                auto const data = m_data.data();
+                auto const [ index, offset ] = div(n, block_size);
+                auto i = last_block() - index;
+                if (auto const reverse_offset = block_size - 1 - offset; reverse_offset) {
+                        if (auto const block = static_cast<block_type>(data[i] >> reverse_offset); block) {
+                                return n - std::countr_zero(block);
+                        }
+                        ++i;
+                        n -= block_size - reverse_offset;
+                }
+                assert(i < num_logical_blocks());
+                auto const j = i + detail::first_nonzero(data + i, num_logical_blocks() - 1 - i);
+                return n - (j - i) * block_size - std::countr_zero(data[j]);
+        }
+
+        template<bool IsConst>
+        class proxy_reference
+        {
+                using rimpl_type = std::conditional_t<IsConst, dynamic_bit_set const&, dynamic_bit_set&>;
+                using value_type = dynamic_bit_set::value_type;
+                rimpl_type m_ref;
+                value_type m_val;
+        public:
+                ~proxy_reference() = default;
+                proxy_reference(proxy_reference const&) = default;
+                proxy_reference(proxy_reference&&) = default;
+                proxy_reference& operator=(proxy_reference const&) = delete;
+                proxy_reference& operator=(proxy_reference&&) = delete;
+
+                proxy_reference() = delete;
+
+                [[nodiscard]] constexpr proxy_reference(rimpl_type r, value_type v) noexcept
+                :
+                        m_ref(r),
+                        m_val(v)
+                {
+                        assert(m_ref.is_valid(m_val));
+                }
+
+                [[nodiscard]] constexpr auto operator==(proxy_reference const& other) const noexcept
+                {
+                        return this->m_val == other.m_val;
+                }
+
+                [[nodiscard]] constexpr auto operator&() const noexcept
+                        -> proxy_iterator<IsConst>
+                {
+                        return { &m_ref, m_val };
+                }
+
+                [[nodiscard]] explicit(false) constexpr operator value_type() const noexcept
+                {
+                        return m_val;
+                }
+
+                template<class T>
+                [[nodiscard]] explicit(false) constexpr operator T() const noexcept(noexcept(T(m_val)))
+                        requires std::is_class_v<T> && std::constructible_from<T, value_type>
+                {
+                        return m_val;
+                }
+        };
+
+        template<bool IsConst>
+        class proxy_iterator
+        {
+        public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using difference_type   = dynamic_bit_set::difference_type;
+                using value_type        = dynamic_bit_set::value_type;
+                using pointer           = proxy_iterator<IsConst>;
+                using reference         = proxy_reference<IsConst>;
+
+        private:
+                using pimpl_type = std::conditional_t<IsConst, dynamic_bit_set const*, dynamic_bit_set*>;
+                pimpl_type m_ptr;
+                value_type m_val;
+
+        public:
+                proxy_iterator() = default;
+
+                [[nodiscard]] constexpr proxy_iterator(pimpl_type p, value_type v) noexcept
+                :
+                        m_ptr(p),
+                        m_val(v)
+                {
+                        assert(m_ptr->in_range(m_val));
+                }
+
+                [[nodiscard]] constexpr auto operator==(proxy_iterator const& other) const noexcept
+                {
+                        assert(this->m_ptr == other.m_ptr);
+                        return this->m_val == other.m_val;
+                }
+
+                [[nodiscard]] constexpr auto operator*() const noexcept
+                        -> proxy_reference<IsConst>
+                {
+                        assert(m_ptr->is_valid(m_val));
+                        return { *m_ptr, m_val };
+                }
+
+                constexpr auto& operator++() noexcept
+                {
+                        assert(m_ptr->is_valid(m_val));
+                        m_val = m_ptr->find_next(m_val + 1);
+                        assert(m_ptr->is_valid(m_val - 1));
+                        return *this;
+                }
+
+                constexpr auto operator++(int) noexcept
+                {
+                        auto nrv = *this; ++*this; return nrv;
+                }
+
+                constexpr auto& operator--() noexcept
+                {
+                        assert(m_ptr->is_valid(m_val - 1));
+                        m_val = m_ptr->find_prev(m_val - 1);
+                        assert(m_ptr->is_valid(m_val));
+                        return *this;
+                }
+
+                constexpr auto operator--(int) noexcept
+                {
+                        auto nrv = *this; --*this; return nrv;
+                }
+        };
+};
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator~(dynamic_bit_set<Block, Allocator, Storage> const& lhs)
+{
+        auto nrv = lhs; nrv.complement(); return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator&(dynamic_bit_set<Block, Allocator, Storage> const& lhs, dynamic_bit_set<Block, Allocator, Storage> const& rhs)
+{
+        auto nrv = lhs; nrv &= rhs; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator|(dynamic_bit_set<Block, Allocator, Storage> const& lhs, dynamic_bit_set<Block, Allocator, Storage> const& rhs)
+{
+        auto nrv = lhs; nrv |= rhs; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator^(dynamic_bit_set<Block, Allocator, Storage> const& lhs, dynamic_bit_set<Block, Allocator, Storage> const& rhs)
+{
+        auto nrv = lhs; nrv ^= rhs; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator-(dynamic_bit_set<Block, Allocator, Storage> const& lhs, dynamic_bit_set<Block, Allocator, Storage> const& rhs)
+{
+        auto nrv = lhs; nrv -= rhs; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator<<(dynamic_bit_set<Block, Allocator, Storage> const& lhs, int n)
+{
+        auto nrv = lhs; nrv <<= n; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto operator>>(dynamic_bit_set<Block, Allocator, Storage> const& lhs, int n)
+{
+        auto nrv = lhs; nrv >>= n; return nrv;
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+constexpr auto swap(dynamic_bit_set<Block, Allocator, Storage>& lhs, dynamic_bit_set<Block, Allocator, Storage>& rhs) noexcept
+{
+        lhs.swap(rhs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto begin(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+{
+        return bs.begin();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto begin(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.begin();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto end(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+{
+        return bs.end();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto end(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.end();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto rbegin(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+{
+        return bs.rbegin();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto rbegin(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.rbegin();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto rend(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+{
+        return bs.rend();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto rend(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.rend();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto cbegin(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return xstd::begin(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto cend(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return xstd::end(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto crbegin(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return xstd::rbegin(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto crend(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return xstd::rend(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto size(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.size();
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto ssize(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        using R = std::common_type_t<std::ptrdiff_t, std::make_signed_t<decltype(bs.size())>>;
+        return static_cast<R>(bs.size());
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] constexpr auto empty(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return bs.empty();
+}
+
+namespace detail {
+
+struct dynamic_bit_set_access
+{
+        template<std::unsigned_integral Block, class Allocator, class Storage>
+        [[nodiscard]] static constexpr auto block(dynamic_bit_set<Block, Allocator, Storage> const& bs, int i) noexcept
+        {
+                return bs.m_data[static_cast<std::size_t>(i)];
+        }
+
+        // The logical blocks, as a span.
+        template<std::unsigned_integral Block, class Allocator, class Storage>
+        [[nodiscard]] static constexpr auto blocks(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+        {
+                return std::span<Block>(bs.m_data.data(), static_cast<std::size_t>(bs.num_logical_blocks()));
+        }
+
+        template<std::unsigned_integral Block, class Allocator, class Storage>
+        [[nodiscard]] static constexpr auto blocks(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+        {
+                return std::span<Block const>(bs.m_data.data(), static_cast<std::size_t>(bs.num_logical_blocks()));
+        }
+
+        // popcount(Op(lhs, rhs)) in a single pass, without materializing Op(lhs, rhs)
+        template<class Op, std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+        [[nodiscard]] static constexpr auto count(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+                -> int
+        {
+                assert(lhs.m_size == rhs.m_size);
+                return detail::count<Op>(lhs.m_data.data(), rhs.m_data.data(), lhs.num_logical_blocks());
+        }
+};
+
+}       // namespace detail
+
+template<std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+[[nodiscard]] constexpr auto intersection_size(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::dynamic_bit_set_access::count<detail::bit_and>(lhs, rhs));
+}
+
+template<std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+[[nodiscard]] constexpr auto union_size(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::dynamic_bit_set_access::count<detail::bit_or>(lhs, rhs));
+}
+
+template<std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+[[nodiscard]] constexpr auto difference_size(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::dynamic_bit_set_access::count<detail::bit_minus>(lhs, rhs));
+}
+
+template<std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+[[nodiscard]] constexpr auto symmetric_difference_size(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+{
+        return static_cast<std::size_t>(detail::dynamic_bit_set_access::count<detail::bit_xor>(lhs, rhs));
+}
+
+// Jaccard (or Tanimoto) similarity |lhs & rhs| / |lhs | rhs|, defined as 1 for two empty sets.
+template<std::unsigned_integral Block, class LhsAllocator, class LhsStorage, class RhsAllocator, class RhsStorage>
+[[nodiscard]] constexpr auto jaccard_index(dynamic_bit_set<Block, LhsAllocator, LhsStorage> const& lhs, dynamic_bit_set<Block, RhsAllocator, RhsStorage> const& rhs) noexcept
+        -> double
+{
+        auto const num_union = union_size(lhs, rhs);
+        return num_union ? static_cast<double>(intersection_size(lhs, rhs)) / static_cast<double>(num_union) : 1.0;
+}
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -0,0 +1,424 @@
+#ifndef XSTD_EXECUTION_HPP
+#define XSTD_EXECUTION_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <xstd/detail/block_kernels.hpp> // bit_and, bit_lhs, bit_minus, bit_or, bit_xor, count, popcount, transform
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set, dynamic_bit_set_access
+#include <algorithm>                     // max, min
+#include <atomic>                        // atomic, memory_order_relaxed
+#include <bit>                           // countl_zero
+#include <cassert>                       // assert
+#include <concepts>                      // unsigned_integral
+#include <condition_variable>            // condition_variable
+#include <cstddef>                       // ptrdiff_t, size_t
+#include <cstdint>                       // uintptr_t
+#include <limits>                        // digits
+#include <mutex>                         // lock_guard, mutex, try_to_lock, unique_lock
+#include <numeric>                       // accumulate
+#include <span>                          // span
+#include <thread>                        // hardware_concurrency, thread
+#include <vector>                        // vector
+
+namespace xstd {
+namespace execution {
+
+// The number of threads over which the parallel overloads below split a set, where 0 means
+// std::thread::hardware_concurrency(). A set is only split into as many chunks as have at
+// least min_chunk_bytes of blocks, so that small sets run on the calling thread only. Waking a
+// worker costs several microseconds, in which a single thread runs through hundreds of KiB.
+class parallel_policy
+{
+        int m_num_threads = 0;
+        std::size_t m_min_chunk_bytes = default_min_chunk_bytes;
+public:
+        static constexpr auto default_min_chunk_bytes = std::size_t(1) << 20;
+
+        parallel_policy() = default;
+
+        [[nodiscard]] constexpr explicit parallel_policy(int num_threads, std::size_t min_chunk_bytes = default_min_chunk_bytes) noexcept
+        :
+                m_num_threads(num_threads),
+                m_min_chunk_bytes(min_chunk_bytes)
+        {
+                assert(0 <= num_threads);
+                assert(0 < min_chunk_bytes);
+        }
+
+        [[nodiscard]] auto num_threads() const noexcept
+        {
+                return m_num_threads ? m_num_threads : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+        }
+
+        [[nodiscard]] constexpr auto min_chunk_bytes() const noexcept
+        {
+                return m_min_chunk_bytes;
+        }
+};
+
+inline constexpr auto par = parallel_policy();
+
+}       // namespace execution
+
+namespace detail {
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] auto blocks(bit_set<N, Block, Storage>& bs) noexcept
+{
+        return bit_set_access::blocks(bs);
+}
+
+template<std::size_t N, std::unsigned_integral Block, class Storage>
+[[nodiscard]] auto blocks(bit_set<N, Block, Storage> const& bs) noexcept
+{
+        return bit_set_access::blocks(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] auto blocks(dynamic_bit_set<Block, Allocator, Storage>& bs) noexcept
+{
+        return dynamic_bit_set_access::blocks(bs);
+}
+
+template<std::unsigned_integral Block, class Allocator, class Storage>
+[[nodiscard]] auto blocks(dynamic_bit_set<Block, Allocator, Storage> const& bs) noexcept
+{
+        return dynamic_bit_set_access::blocks(bs);
+}
+
+template<class Set>
+concept parallel_set = requires(Set& bs) { detail::blocks(bs); };
+
+// Worker threads that persist across the parallel overloads below, so that a call only pays for
+// waking the workers rather than for creating and joining threads. The workers are created on
+// first use, as many as the largest policy so far asks for, and are joined at program exit.
+// A single job runs at a time: a call made while the pool is busy, from another thread or from
+// within a job, runs all of its tasks on the calling thread instead.
+class thread_pool
+{
+        std::mutex m_job;               // held by the thread that submitted the current job
+        std::mutex m_mutex;             // guards all members below
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        std::vector<std::thread> m_workers;
+        void (*m_call)(void*, std::size_t) = nullptr;
+        void* m_task = nullptr;
+        std::size_t m_num_tasks = 0;
+        std::size_t m_next = 0;         // the next task to be claimed
+        std::size_t m_pending = 0;      // the number of tasks not yet finished
+        bool m_stop = false;
+
+        // Runs the unclaimed tasks of the current job, with lock held on entry and on exit.
+        // The tasks do not throw: an exception terminates, as it would on a worker.
+        auto drain(std::unique_lock<std::mutex>& lock) noexcept
+        {
+                while (m_next < m_num_tasks) {
+                        auto const task = m_next++;
+                        lock.unlock();
+                        m_call(m_task, task);
+                        lock.lock();
+                        if (--m_pending == 0) {
+                                m_done.notify_one();
+                        }
+                }
+        }
+
+        auto work() noexcept
+        {
+                auto lock = std::unique_lock(m_mutex);
+                while (true) {
+                        m_wake.wait(lock, [&] { return m_stop || m_next < m_num_tasks; });
+                        if (m_stop) {
+                                return;
+                        }
+                        drain(lock);
+                }
+        }
+
+public:
+        thread_pool() = default;
+        thread_pool(thread_pool const&) = delete;
+        thread_pool& operator=(thread_pool const&) = delete;
+
+        ~thread_pool()
+        {
+                {
+                        auto const lock = std::lock_guard(m_mutex);
+                        m_stop = true;
+                }
+                m_wake.notify_all();
+                for (auto& worker : m_workers) {
+                        worker.join();
+                }
+        }
+
+        // Calls task(i) for all 0 <= i < num_tasks on at most num_threads threads, including the
+        // calling thread, and returns when all calls have returned.
+        template<class Task>
+        auto run(std::size_t num_threads, std::size_t num_tasks, Task& task)
+        {
+                auto job = std::unique_lock(m_job, std::try_to_lock);
+                if (num_threads <= 1 || num_tasks <= 1 || !job) {
+                        for (auto i = std::size_t(0); i < num_tasks; ++i) {
+                                task(i);
+                        }
+                        return;
+                }
+                auto lock = std::unique_lock(m_mutex);
+                while (m_workers.size() < num_threads - 1) {
+                        m_workers.emplace_back([this] { work(); });
+                }
+                m_call = [](void* t, std::size_t i) { (*static_cast<Task*>(t))(i); };
+                m_task = &task;
+                m_num_tasks = num_tasks;
+                m_next = 0;
+                m_pending = num_tasks;
+                m_wake.notify_all();
+                drain(lock);
+                m_done.wait(lock, [&] { return m_pending == 0; });
+        }
+};
+
+[[nodiscard]] inline auto shared_pool()
+        -> thread_pool&
+{
+        static thread_pool pool;
+        return pool;
+}
+
+// Calls fun(chunk, first, last) for consecutive chunks [first, last) of the n blocks at data,
+// spread over the calling thread and the workers of the shared pool. Interior chunk boundaries
+// are at 64-byte aligned addresses, so that no two threads write to the same cache line.
+// Returns the number of chunks.
+template<std::unsigned_integral Block, class Fun>
+auto parallel_for(execution::parallel_policy policy, Block const* data, std::size_t n, Fun fun)
+        -> std::size_t
+{
+        constexpr auto cache_line_bytes = std::size_t(64);
+        constexpr auto cache_line_blocks = std::max(cache_line_bytes / sizeof(Block), std::size_t(1));
+        auto const max_chunks = std::max(n * sizeof(Block) / policy.min_chunk_bytes(), std::size_t(1));
+        auto const num_chunks = std::min(static_cast<std::size_t>(policy.num_threads()), max_chunks);
+        auto const chunk_size = ((n + num_chunks - 1) / num_chunks + cache_line_blocks - 1) / cache_line_blocks * cache_line_blocks;
+        // the number of blocks before the first cache line boundary at or after data
+        auto const skew = (cache_line_bytes - reinterpret_cast<std::uintptr_t>(data) % cache_line_bytes) % cache_line_bytes / sizeof(Block);
+        auto const boundary = [=](std::size_t chunk) {
+                return chunk ? std::min(skew + chunk * chunk_size, n) : std::size_t(0);
+        };
+        auto task = [&](std::size_t chunk) {
+                fun(chunk, boundary(chunk), boundary(chunk + 1));
+        };
+        detail::shared_pool().run(num_chunks, num_chunks, task);
+        return num_chunks;
+}
+
+// lhs[i] = Op(lhs[i], rhs[i]) for all blocks, in parallel
+template<class Op, class Set>
+auto parallel_transform(execution::parallel_policy policy, Set& lhs, Set const& rhs)
+        -> Set&
+{
+        assert(lhs.max_size() == rhs.max_size());
+        auto const dst = detail::blocks(lhs);
+        auto const src = detail::blocks(rhs);
+        detail::parallel_for(policy, dst.data(), dst.size(), [=](std::size_t, std::size_t first, std::size_t last) {
+                detail::transform<Op>(dst.data() + first, src.data() + first, static_cast<int>(last - first));
+        });
+        return lhs;
+}
+
+// The number of 1-bits in Op(lhs[i], rhs[i]) summed over all blocks, in parallel
+template<class Op, class Set>
+[[nodiscard]] auto parallel_count(execution::parallel_policy policy, Set const& lhs, Set const& rhs)
+        -> std::ptrdiff_t
+{
+        assert(lhs.max_size() == rhs.max_size());
+        auto const l = detail::blocks(lhs);
+        auto const r = detail::blocks(rhs);
+        std::vector<std::ptrdiff_t> partials(static_cast<std::size_t>(policy.num_threads()));
+        auto const num_chunks = detail::parallel_for(policy, l.data(), l.size(), [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                partials[chunk] = detail::count<Op>(l.data() + first, r.data() + first, static_cast<int>(last - first));
+        });
+        return std::accumulate(partials.begin(), partials.begin() + static_cast<std::ptrdiff_t>(num_chunks), std::ptrdiff_t(0));
+}
+
+// Whether Op(lhs[i], rhs[i]) is non-zero for any block, in parallel. Each thread ORs its chunk
+// together in slices and stops as soon as any thread has found a non-zero block.
+template<class Op, class Set>
+[[nodiscard]] auto parallel_any(execution::parallel_policy policy, Set const& lhs, Set const& rhs)
+        -> bool
+{
+        assert(lhs.max_size() == rhs.max_size());
+        using block_type = typename Set::block_type;
+        constexpr auto slice_size = std::size_t(1 << 12);
+        auto const l = detail::blocks(lhs);
+        auto const r = detail::blocks(rhs);
+        std::atomic<bool> found = false;
+        detail::parallel_for(policy, l.data(), l.size(), [&](std::size_t, std::size_t first, std::size_t last) {
+                for (auto i = first; i < last && !found.load(std::memory_order_relaxed); i += slice_size) {
+                        auto any = block_type(0);
+                        for (auto j = i, end = std::min(i + slice_size, last); j < end; ++j) {
+                                any |= Op::apply(l[j], r[j]);
+                        }
+                        if (any) {
+                                found.store(true, std::memory_order_relaxed);
+                        }
+                }
+        });
+        return found.load(std::memory_order_relaxed);
+}
+
+// Cuts the blocks, in ascending order of values, into at most num_chunks ranges with about equal
+// numbers of elements, where counts[g] is the number of elements in group g of group_size blocks.
+// Returns the group boundaries of the chunks, from 0 to counts.size().
+[[nodiscard]] inline auto balanced_chunks(std::span<std::ptrdiff_t const> counts, std::size_t num_chunks)
+        -> std::vector<std::size_t>
+{
+        auto const total = std::accumulate(counts.begin(), counts.end(), std::ptrdiff_t(0));
+        std::vector<std::size_t> nrv{ 0 };
+        auto sum = std::ptrdiff_t(0);
+        for (auto g = std::size_t(0); g < counts.size(); ++g) {
+                sum += counts[g];
+                // cut after group g once it reaches the next multiple of total / num_chunks
+                if (nrv.size() < num_chunks && sum * static_cast<std::ptrdiff_t>(num_chunks) >= total * static_cast<std::ptrdiff_t>(nrv.size()) && counts[g]) {
+                        nrv.push_back(g + 1);
+                }
+        }
+        if (nrv.back() != counts.size()) {
+                nrv.push_back(counts.size());
+        }
+        return nrv;
+}
+
+}       // namespace detail
+
+// Overloads of the bulk operations of bit_set and dynamic_bit_set that split the blocks over
+// multiple threads, for sets of millions of elements where a single core cannot saturate the
+// memory bandwidth. The compound assignments are named after their operators.
+
+template<detail::parallel_set Set>
+auto and_assign(execution::parallel_policy policy, Set& lhs, Set const& rhs)
+        -> Set&
+{
+        return detail::parallel_transform<detail::bit_and>(policy, lhs, rhs);
+}
+
+template<detail::parallel_set Set>
+auto or_assign(execution::parallel_policy policy, Set& lhs, Set const& rhs)
+        -> Set&
+{
+        return detail::parallel_transform<detail::bit_or>(policy, lhs, rhs);
+}
+
+template<detail::parallel_set Set>
+auto xor_assign(execution::parallel_policy policy, Set& lhs, Set const& rhs)
+        -> Set&
+{
+        return detail::parallel_transform<detail::bit_xor>(policy, lhs, rhs);
+}
+
+template<detail::parallel_set Set>
+auto minus_assign(execution::parallel_policy policy, Set& lhs, Set const& rhs)
+        -> Set&
+{
+        return detail::parallel_transform<detail::bit_minus>(policy, lhs, rhs);
+}
+
+template<detail::parallel_set Set>
+[[nodiscard]] auto ssize(execution::parallel_policy policy, Set const& bs)
+        -> std::ptrdiff_t
+{
+        return detail::parallel_count<detail::bit_lhs>(policy, bs, bs);
+}
+
+template<detail::parallel_set Set>
+[[nodiscard]] auto size(execution::parallel_policy policy, Set const& bs)
+        -> std::size_t
+{
+        return static_cast<std::size_t>(xstd::ssize(policy, bs));
+}
+
+template<detail::parallel_set Set>
+[[nodiscard]] auto intersection_size(execution::parallel_policy policy, Set const& lhs, Set const& rhs)
+        -> std::size_t
+{
+        return static_cast<std::size_t>(detail::parallel_count<detail::bit_and>(policy, lhs, rhs));
+}
+
+template<detail::parallel_set Set>
+[[nodiscard]] auto is_subset_of(execution::parallel_policy policy, Set const& lhs, Set const& rhs)
+        -> bool
+{
+        return !detail::parallel_any<detail::bit_minus>(policy, lhs, rhs);
+}
+
+template<detail::parallel_set Set>
+[[nodiscard]] auto intersects(execution::parallel_policy policy, Set const& lhs, Set const& rhs)
+        -> bool
+{
+        return detail::parallel_any<detail::bit_and>(policy, lhs, rhs);
+}
+
+// Calls fun(x) for all elements x, concurrently from multiple threads and in no particular order
+// across threads, so fun must be safe to call concurrently. The blocks are cut into several chunks
+// per thread with equal numbers of elements, using the popcounts of groups of blocks, so that an
+// uneven density does not leave threads idle. The threads take the next unprocessed chunk until
+// none is left, and extract the elements of each block with countl_zero, as bit_set::for_each
+// does. As for the parallel standard algorithms, an exception thrown by fun calls std::terminate.
+template<detail::parallel_set Set, class UnaryFunction>
+auto for_each(execution::parallel_policy policy, Set const& bs, UnaryFunction fun)
+{
+        using block_type = typename Set::block_type;
+        constexpr auto block_size = std::numeric_limits<block_type>::digits;
+        constexpr auto last_bit = static_cast<block_type>(static_cast<block_type>(1) << (block_size - 1));
+        constexpr auto group_size = std::size_t(64);
+        constexpr auto chunks_per_thread = std::size_t(8);
+
+        auto const b = detail::blocks(bs);
+        auto const n = b.size();
+        auto const num_groups = (n + group_size - 1) / group_size;
+
+        // group g holds the blocks n - 1 - j for j in [g * group_size, (g + 1) * group_size)
+        auto const group_blocks = [=](std::size_t g) {
+                auto const first = g * group_size;
+                auto const last = std::min(first + group_size, n);
+                return b.subspan(n - last, last - first);
+        };
+        std::vector<std::ptrdiff_t> counts(num_groups);
+        // each chunk of blocks counts the groups that start in it
+        detail::parallel_for(policy, b.data(), n, [&](std::size_t, std::size_t first, std::size_t last) {
+                for (auto g = (first + group_size - 1) / group_size; g < (last + group_size - 1) / group_size; ++g) {
+                        auto const blocks = group_blocks(g);
+                        counts[g] = detail::popcount(blocks.data(), static_cast<int>(blocks.size()));
+                }
+        });
+
+        auto const num_threads = static_cast<std::size_t>(policy.num_threads());
+        auto const chunks = detail::balanced_chunks(counts, num_threads * chunks_per_thread);
+        auto const num_chunks = chunks.size() - 1;
+        std::atomic<std::size_t> next = 0;
+        auto const worker = [&] {
+                for (auto c = next.fetch_add(1, std::memory_order_relaxed); c < num_chunks; c = next.fetch_add(1, std::memory_order_relaxed)) {
+                        auto const last = std::min(chunks[c + 1] * group_size, n);
+                        for (auto j = chunks[c] * group_size; j < last; ++j) {
+                                auto const base = static_cast<int>(j) * block_size;
+                                for (auto block = b[n - 1 - j]; block; /* update inside loop */) {
+                                        auto const offset = std::countl_zero(block);
+                                        fun(base + offset);
+                                        block ^= static_cast<block_type>(last_bit >> offset);
+                                }
+                        }
+                }
+        };
+        auto task = [&](std::size_t) {
+                worker();
+        };
+        auto const num_workers = std::min(num_threads, num_chunks);
+        detail::shared_pool().run(num_workers, num_workers, task);
+}
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -0,0 +1,224 @@
+#ifndef XSTD_ID_ALLOCATOR_HPP
+#define XSTD_ID_ALLOCATOR_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <algorithm>                     // min
+#include <atomic>                        // atomic_ref, memory_order_acquire, memory_order_relaxed, memory_order_release
+#include <bit>                           // countl_zero, popcount
+#include <cassert>                       // assert
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // size_t
+#include <functional>                    // hash
+#include <limits>                        // digits
+#include <optional>                      // nullopt, optional
+#include <span>                          // span
+#include <thread>                        // this_thread::get_id
+
+namespace xstd {
+
+// A lock-free allocator of the integer IDs in [0, N), e.g. connection slots or buffer indices.
+// The allocated IDs are the elements of a bit_set<N, Block>. An allocation scans the blocks for a
+// clear bit, one word at a time, and claims it with a compare-and-swap on its block, retrying on
+// that block only if another thread changed it in between. A release is a single fetch_and.
+// Each thread starts its scans at the block of its previous allocation (initially a block picked
+// by its thread id), so that concurrent threads mostly work on different blocks. The IDs are
+// therefore not necessarily the smallest free ones. A successful allocation synchronizes with
+// the release of the same ID, so that the new owner sees the writes of the previous one.
+template<std::size_t N, std::unsigned_integral Block = std::size_t>
+class id_allocator
+{
+        static_assert(0 < N && N <= std::numeric_limits<int>::max());
+        static_assert(std::atomic_ref<Block>::is_always_lock_free);
+        static_assert(std::atomic_ref<Block>::required_alignment <= alignof(Block));
+
+        static constexpr auto M = static_cast<int>(N);
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto num_blocks = (M - 1 + block_size) / block_size;
+        static constexpr auto num_unused_bits = num_blocks * block_size - M;
+        static constexpr auto ones = static_cast<Block>(~static_cast<Block>(0));
+        static constexpr auto last_bit = static_cast<Block>(static_cast<Block>(1) << (block_size - 1));
+
+        using bits_type = bit_set<N, Block>;
+
+        mutable bits_type m_bits;
+
+        // The block index in [0, num_blocks) of the next scan of the calling thread, in ascending
+        // order of IDs, shared by all id_allocator objects of the same type.
+        inline static thread_local auto t_hint = -1;
+public:
+        using value_type             = int;
+        using size_type              = std::size_t;
+        using block_type             = Block;
+
+        id_allocator() = default;                       // all IDs are free
+
+        id_allocator(id_allocator const&) = delete;
+        id_allocator& operator=(id_allocator const&) = delete;
+
+        [[nodiscard]] static constexpr auto max_size() noexcept
+                -> size_type
+        {
+                return N;
+        }
+
+        // A free ID, which is now allocated, or std::nullopt if all IDs were allocated during the scan.
+        [[nodiscard]] auto allocate() noexcept
+                -> std::optional<value_type>
+        {
+                auto nrv = std::optional<value_type>();
+                scan([&](int j, Block free) {
+                        free = lowest(free, 1);
+                        if (claim(j, free)) {
+                                nrv = j * block_size + std::countl_zero(free);
+                                return true;
+                        }
+                        return false;
+                });
+                return nrv;
+        }
+
+        // Allocates up to out.size() free IDs into out, claiming as many IDs per compare-and-swap as
+        // a block has free, and returns how many it allocated. This is less than out.size() only if
+        // all IDs were allocated during the scan.
+        auto allocate(std::span<value_type> out) noexcept
+                -> size_type
+        {
+                auto n = size_type(0);
+                if (out.empty()) {
+                        return n;
+                }
+                scan([&](int j, Block free) {
+                        free = lowest(free, out.size() - n);
+                        if (!claim(j, free)) {
+                                return false;
+                        }
+                        for (/* init-statement before loop */; free; free = clear_first(free)) {
+                                out[n++] = j * block_size + std::countl_zero(free);
+                        }
+                        return n == out.size();
+                });
+                return n;
+        }
+
+        // Frees an allocated ID.
+        auto release(value_type x) noexcept
+        {
+                assert(0 <= x && x < M);
+                auto const mask = static_cast<Block>(last_bit >> (x % block_size));
+                [[maybe_unused]] auto const old = ref(x / block_size).fetch_and(static_cast<Block>(~mask), std::memory_order_release);
+                assert(old & mask);
+        }
+
+        // Frees allocated IDs, with a single fetch_and for each run of IDs in the same block.
+        auto release(std::span<value_type const> ids) noexcept
+        {
+                for (auto first = ids.begin(); first != ids.end(); /* update inside loop */) {
+                        auto const j = *first / block_size;
+                        auto mask = Block(0);
+                        for (/* init-statement before loop */; first != ids.end() && *first / block_size == j; ++first) {
+                                assert(0 <= *first && *first < M);
+                                mask |= static_cast<Block>(last_bit >> (*first % block_size));
+                        }
+                        [[maybe_unused]] auto const old = ref(j).fetch_and(static_cast<Block>(~mask), std::memory_order_release);
+                        assert((old & mask) == mask);
+                }
+        }
+
+        [[nodiscard]] auto contains(value_type x) const noexcept
+                -> bool
+        {
+                assert(0 <= x && x < M);
+                return ref(x / block_size).load(std::memory_order_acquire) & static_cast<Block>(last_bit >> (x % block_size));
+        }
+
+        // The allocated IDs, with each block loaded at some point during the copy.
+        [[nodiscard]] auto snapshot() const noexcept
+                -> bits_type
+        {
+                bits_type nrv;
+                auto const data = detail::bit_set_access::data(nrv);
+                for (auto j = 0; j < num_blocks; ++j) {
+                        data[num_blocks - 1 - j] = ref(j).load(std::memory_order_relaxed);
+                }
+                return nrv;
+        }
+
+private:
+        // The IDs j * block_size + offset in a block j are at bit block_size - 1 - offset, and the
+        // unused bits past N are the low bits of the last block.
+        [[nodiscard]] static constexpr auto valid_bits(int j) noexcept
+        {
+                return j == num_blocks - 1 ? static_cast<Block>(ones << num_unused_bits) : ones;
+        }
+
+        // The bit of the lowest ID in a non-zero mask, cleared.
+        [[nodiscard]] static constexpr auto clear_first(Block mask) noexcept
+        {
+                return static_cast<Block>(mask & ~(last_bit >> std::countl_zero(mask)));
+        }
+
+        // The bits of the lowest n <= popcount(free) IDs in a non-zero mask.
+        [[nodiscard]] static constexpr auto lowest(Block free, size_type n) noexcept
+        {
+                if (n >= static_cast<size_type>(std::popcount(free))) {
+                        return free;
+                }
+                auto rest = free;
+                for (auto i = size_type(0); i < n; ++i) {
+                        rest = clear_first(rest);
+                }
+                return static_cast<Block>(free & ~rest);
+        }
+
+        [[nodiscard]] auto ref(int j) const noexcept
+        {
+                return std::atomic_ref<Block>(detail::bit_set_access::data(m_bits)[num_blocks - 1 - j]);
+        }
+
+        // Calls fun(j, free) with the free bits of each block j that has any, starting at the
+        // hint of the calling thread, until fun returns true. A block is retried while
+        // fun returns false because another thread changed it.
+        template<class Fun>
+        auto scan(Fun fun) noexcept
+        {
+                if (t_hint < 0 || t_hint >= num_blocks) {
+                        t_hint = static_cast<int>(std::hash<std::thread::id>()(std::this_thread::get_id()) % static_cast<std::size_t>(num_blocks));
+                }
+                for (auto step = 0, j = t_hint; step < num_blocks; ++step, j = j + 1 == num_blocks ? 0 : j + 1) {
+                        for (auto free = free_bits(j); free; free = free_bits(j)) {
+                                if (fun(j, free)) {
+                                        t_hint = j;
+                                        return;
+                                }
+                        }
+                }
+        }
+
+        [[nodiscard]] auto free_bits(int j) const noexcept
+        {
+                return static_cast<Block>(~ref(j).load(std::memory_order_relaxed) & valid_bits(j));
+        }
+
+        // Sets the bits of mask in block j, if all of them are still clear.
+        auto claim(int j, Block mask) noexcept
+                -> bool
+        {
+                auto r = ref(j);
+                auto expected = r.load(std::memory_order_relaxed);
+                while (!(expected & mask)) {
+                        if (r.compare_exchange_weak(expected, static_cast<Block>(expected | mask), std::memory_order_acquire, std::memory_order_relaxed)) {
+                                return true;
+                        }
+                }
+                return false;
+        }
+};
+
+}       // namespace xstd
+
+#endif  // include guard
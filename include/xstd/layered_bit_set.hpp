@@ -0,0 +1,622 @@
+#ifndef XSTD_LAYERED_BIT_SET_HPP
+#define XSTD_LAYERED_BIT_SET_HPP
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set, bit_set_access
+#include <bit>                           // countl_zero, countr_zero
+#include <cassert>                       // assert
+#include <compare>                       // strong_ordering
+#include <concepts>                      // constructible_from, input_iterator, unsigned_integral
+#include <cstddef>                       // ptrdiff_t, size_t
+#include <functional>                    // less
+#include <initializer_list>              // initializer_list
+#include <iterator>                      // bidirectional_iterator_tag, reverse_iterator
+#include <limits>                        // digits
+#include <ranges>                        // begin, end, range
+#include <type_traits>                   // conditional_t
+#include <utility>                       // forward, pair
+#include <vector>                        // vector
+
+namespace xstd {
+
+namespace detail {
+
+struct no_summary {};
+
+}       // namespace detail
+
+// A bit_set with a summary of one bit per non-empty block, which is itself a layered_bit_set,
+// down to a single block. A search for the next or previous element touches at most two blocks
+// per layer, i.e. O(log_64 N) words for 64-bit blocks instead of the O(N / 64) of bit_set.
+// Single-element updates keep the summaries up to date incrementally, and only descend into
+// the next layer when a block changes between empty and non-empty. Bulk operations are delegated
+// to the bit_set and rebuild the summaries in one pass.
+template<std::size_t N, std::unsigned_integral Block = std::size_t>
+class layered_bit_set
+{
+        static_assert(N <= std::numeric_limits<int>::max());
+
+        static constexpr auto M = static_cast<int>(N);
+        static constexpr auto block_size = std::numeric_limits<Block>::digits;
+        static constexpr auto num_blocks = (M - 1 + block_size) / block_size;
+        static constexpr auto has_summary = num_blocks > 1;
+        static constexpr auto ones = static_cast<Block>(~static_cast<Block>(0));
+        static constexpr auto last_bit = static_cast<Block>(static_cast<Block>(1) << (block_size - 1));
+
+        using bits_type = bit_set<N, Block>;
+        using summary_type = std::conditional_t<has_summary, layered_bit_set<static_cast<std::size_t>(num_blocks), Block>, detail::no_summary>;
+
+        class const_iterator_impl;
+
+        bits_type m_bits;
+        [[no_unique_address]] summary_type m_summary;
+
+        template<std::size_t, std::unsigned_integral>
+        friend class layered_bit_set;
+public:
+        using key_type               = int;
+        using key_compare            = std::less<key_type>;
+        using value_type             = int;
+        using value_compare          = std::less<value_type>;
+        using pointer                = void;
+        using const_pointer          = void;
+        using reference              = value_type;
+        using const_reference        = value_type;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using iterator               = const_iterator_impl;
+        using const_iterator         = const_iterator_impl;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using block_type             = Block;
+
+        layered_bit_set() = default;                    // zero-initialization
+
+        [[nodiscard]] constexpr explicit layered_bit_set(bits_type const& bits) noexcept
+        :
+                m_bits(bits)
+        {
+                rebuild();
+        }
+
+        template<class InputIterator>
+        [[nodiscard]] constexpr layered_bit_set(InputIterator first, InputIterator last) noexcept
+        {
+                insert(first, last);
+        }
+
+        [[nodiscard]] constexpr layered_bit_set(std::initializer_list<value_type> ilist) noexcept
+        :
+                layered_bit_set(ilist.begin(), ilist.end())
+        {}
+
+        constexpr auto& operator=(std::initializer_list<value_type> ilist) noexcept
+        {
+                clear();
+                insert(ilist.begin(), ilist.end());
+                return *this;
+        }
+
+        // The summaries are a function of the bits.
+        [[nodiscard]] constexpr auto operator==(layered_bit_set const& other) const noexcept
+                -> bool
+        {
+                return this->m_bits == other.m_bits;
+        }
+
+        [[nodiscard]] constexpr auto operator<=>(layered_bit_set const& other) const noexcept
+                -> std::strong_ordering
+        {
+                return this->m_bits <=> other.m_bits;
+        }
+
+        [[nodiscard]] constexpr auto const& bits() const noexcept
+        {
+                return m_bits;
+        }
+
+        [[nodiscard]] constexpr auto begin()   const noexcept -> const_iterator { return { this, find_next(0) }; }
+        [[nodiscard]] constexpr auto end()     const noexcept -> const_iterator { return { this, M }; }
+        [[nodiscard]] constexpr auto rbegin()  const noexcept { return const_reverse_iterator(end()); }
+        [[nodiscard]] constexpr auto rend()    const noexcept { return const_reverse_iterator(begin()); }
+        [[nodiscard]] constexpr auto cbegin()  const noexcept { return begin(); }
+        [[nodiscard]] constexpr auto cend()    const noexcept { return end(); }
+        [[nodiscard]] constexpr auto crbegin() const noexcept { return rbegin(); }
+        [[nodiscard]] constexpr auto crend()   const noexcept { return rend(); }
+
+        [[nodiscard]] constexpr auto front() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return find_next(0);
+        }
+
+        [[nodiscard]] constexpr auto back() const noexcept
+                -> const_reference
+        {
+                assert(!empty());
+                return find_prev(M);
+        }
+
+        // Only looks at the single block of the top layer.
+        [[nodiscard]] constexpr auto empty() const noexcept
+                -> bool
+        {
+                if constexpr (has_summary) {
+                        return m_summary.empty();
+                } else {
+                        return m_bits.empty();
+                }
+        }
+
+        [[nodiscard]] constexpr auto full() const noexcept
+        {
+                return m_bits.full();
+        }
+
+        [[nodiscard]] constexpr auto ssize() const noexcept
+        {
+                return m_bits.ssize();
+        }
+
+        [[nodiscard]] constexpr auto size() const noexcept
+        {
+                return m_bits.size();
+        }
+
+        [[nodiscard]] static constexpr auto max_size() noexcept
+        {
+                return N;
+        }
+
+        template<class... Args>
+        constexpr auto emplace(Args&&... args) noexcept
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        template<class... Args>
+        constexpr auto emplace_hint(const_iterator hint, Args&&... args) noexcept
+                requires (sizeof...(Args) == 1)
+        {
+                return insert(hint, value_type(std::forward<Args>(args)...));
+        }
+
+        constexpr auto add(value_type x) noexcept
+                -> void
+        {
+                assert(is_valid(x));
+                auto const i = x / block_size;
+                auto const was_empty = !block(i);
+                m_bits.add(x);
+                if constexpr (has_summary) {
+                        if (was_empty) {
+                                m_summary.add(i);
+                        }
+                }
+        }
+
+        constexpr auto insert(value_type x) noexcept
+                -> std::pair<iterator, bool>
+        {
+                auto const inserted = !contains(x);
+                add(x);
+                return { { this, x }, inserted };
+        }
+
+        constexpr auto insert(const_iterator /* hint */, value_type x) noexcept
+                -> iterator
+        {
+                add(x);
+                return { this, x };
+        }
+
+        template<class InputIterator>
+        constexpr auto insert(InputIterator first, InputIterator last) noexcept
+                -> void
+                requires std::input_iterator<InputIterator> && std::constructible_from<value_type, decltype(*first)>
+        {
+                for (/* init-statement before loop */; first != last; ++first) {
+                        add(*first);
+                }
+        }
+
+        template<class Range>
+        constexpr auto insert_range(Range&& rg) noexcept
+                requires std::ranges::range<Range> && std::constructible_from<value_type, decltype(*rg.begin())>
+        {
+                insert(std::ranges::begin(rg), std::ranges::end(rg));
+        }
+
+        constexpr auto insert(std::initializer_list<value_type> ilist) noexcept
+        {
+                insert(ilist.begin(), ilist.end());
+        }
+
+        constexpr auto fill() noexcept
+        {
+                m_bits.fill();
+                rebuild();
+        }
+
+        constexpr auto pop(key_type x) noexcept
+                -> void
+        {
+                assert(is_valid(x));
+                auto const i = x / block_size;
+                m_bits.pop(x);
+                if constexpr (has_summary) {
+                        if (!block(i)) {
+                                m_summary.pop(i);
+                        }
+                }
+        }
+
+        constexpr auto erase(key_type x) noexcept
+                -> size_type
+        {
+                auto const n = static_cast<size_type>(contains(x));
+                pop(x);
+                return n;
+        }
+
+        constexpr auto erase(const_iterator pos) noexcept
+                -> iterator
+        {
+                assert(pos != end());
+                auto const x = *pos;
+                pop(x);
+                return { this, find_next(x + 1) };
+        }
+
+        constexpr auto erase(const_iterator first, const_iterator last) noexcept
+                -> iterator
+        {
+                while (first != last) {
+                        first = erase(first);
+                }
+                return last;
+        }
+
+        constexpr auto swap(layered_bit_set& other) noexcept
+        {
+                using std::swap;
+                swap(this->m_bits, other.m_bits);
+                if constexpr (has_summary) {
+                        this->m_summary.swap(other.m_summary);
+                }
+        }
+
+        constexpr auto clear() noexcept
+                -> void
+        {
+                m_bits.clear();
+                if constexpr (has_summary) {
+                        m_summary.clear();
+                }
+        }
+
+        [[nodiscard]] constexpr auto find(key_type x) const noexcept
+        {
+                return contains(x) ? const_iterator(this, x) : end();
+        }
+
+        [[nodiscard]] constexpr auto count(key_type x) const noexcept
+        {
+                return m_bits.count(x);
+        }
+
+        [[nodiscard]] constexpr auto contains(key_type x) const noexcept
+                -> bool
+        {
+                return m_bits.contains(x);
+        }
+
+        [[nodiscard]] constexpr auto lower_bound(key_type x) const noexcept
+                -> const_iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x) };
+        }
+
+        [[nodiscard]] constexpr auto upper_bound(key_type x) const noexcept
+                -> const_iterator
+        {
+                assert(is_valid(x));
+                return { this, find_next(x + 1) };
+        }
+
+        [[nodiscard]] constexpr auto equal_range(key_type x) const noexcept
+                -> std::pair<const_iterator, const_iterator>
+        {
+                return { lower_bound(x), upper_bound(x) };
+        }
+
+        constexpr auto complement() noexcept
+        {
+                m_bits.complement();
+                rebuild();
+        }
+
+        constexpr auto& operator&=(layered_bit_set const& other) noexcept
+        {
+                this->m_bits &= other.m_bits;
+                rebuild();
+                return *this;
+        }
+
+        constexpr auto& operator|=(layered_bit_set const& other) noexcept
+        {
+                this->m_bits |= other.m_bits;
+                rebuild();
+                return *this;
+        }
+
+        constexpr auto& operator^=(layered_bit_set const& other) noexcept
+        {
+                this->m_bits ^= other.m_bits;
+                rebuild();
+                return *this;
+        }
+
+        constexpr auto& operator-=(layered_bit_set const& other) noexcept
+        {
+                this->m_bits -= other.m_bits;
+                rebuild();
+                return *this;
+        }
+
+        [[nodiscard]] constexpr auto is_subset_of(layered_bit_set const& other) const noexcept
+        {
+                return this->m_bits.is_subset_of(other.m_bits);
+        }
+
+        [[nodiscard]] constexpr auto is_proper_subset_of(layered_bit_set const& other) const noexcept
+        {
+                return this->m_bits.is_proper_subset_of(other.m_bits);
+        }
+
+        [[nodiscard]] constexpr auto intersects(layered_bit_set const& other) const noexcept
+        {
+                return this->m_bits.intersects(other.m_bits);
+        }
+
+        // Calls fun(x) for all elements x in ascending order, skipping empty blocks through the summary.
+        template<class UnaryFunction>
+        constexpr auto for_each(UnaryFunction fun) const
+        {
+                for (auto i = find_block(0); i < num_blocks; i = find_block(i + 1)) {
+                        for (auto b = block(i); b; /* increment inside loop */) {
+                                auto const offset = std::countl_zero(b);
+                                fun(i * block_size + offset);
+                                b = static_cast<Block>(b ^ (last_bit >> offset));
+                        }
+                }
+                return fun;
+        }
+
+        [[nodiscard]] auto to_vector() const
+                -> std::vector<value_type>
+        {
+                std::vector<value_type> nrv;
+                nrv.reserve(size());
+                for_each([&](auto x) {
+                        nrv.push_back(x);
+                });
+                return nrv;
+        }
+
+private:
+        [[nodiscard]] static constexpr auto is_valid(value_type x) noexcept
+        {
+                return 0 <= x && x < M;
+        }
+
+        // The block with the elements [i * block_size, (i + 1) * block_size), stored most significant bit first.
+        [[nodiscard]] constexpr auto block(int i) const noexcept
+                -> Block
+        {
+                return detail::bit_set_access::block(m_bits, num_blocks - 1 - i);
+        }
+
+        // The first non-empty block not before 0 <= i <= num_blocks, or num_blocks if there is none.
+        [[nodiscard]] constexpr auto find_block(int i) const noexcept
+                -> int
+        {
+                if constexpr (has_summary) {
+                        return m_summary.find_next(i);
+                } else {
+                        return i < num_blocks && block(i) ? i : num_blocks;
+                }
+        }
+
+        // The first non-empty block before 0 <= i <= num_blocks, or -1 if there is none.
+        [[nodiscard]] constexpr auto find_block_before(int i) const noexcept
+                -> int
+        {
+                if constexpr (has_summary) {
+                        return m_summary.find_prev(i);
+                } else {
+                        return i > 0 && block(0) ? 0 : -1;
+                }
+        }
+
+        // The smallest element not less than 0 <= x <= M, or M if there is none.
+        [[nodiscard]] constexpr auto find_next(int x) const noexcept
+                -> int
+        {
+                if (x >= M) {
+                        return M;
+                }
+                auto const i = x / block_size;
+                if (auto const b = static_cast<Block>(block(i) & static_cast<Block>(ones >> (x % block_size))); b) {
+                        return i * block_size + std::countl_zero(b);
+                }
+                auto const j = find_block(i + 1);
+                return j == num_blocks ? M : j * block_size + std::countl_zero(block(j));
+        }
+
+        // The largest element less than 0 <= x <= M, or -1 if there is none.
+        [[nodiscard]] constexpr auto find_prev(int x) const noexcept
+                -> int
+        {
+                if (x <= 0) {
+                        return -1;
+                }
+                auto const i = (x - 1) / block_size;
+                if (auto const b = static_cast<Block>(block(i) & static_cast<Block>(ones << (block_size - 1 - (x - 1) % block_size))); b) {
+                        return i * block_size + block_size - 1 - std::countr_zero(b);
+                }
+                auto const j = find_block_before(i);
+                return j < 0 ? -1 : j * block_size + block_size - 1 - std::countr_zero(block(j));
+        }
+
+        // Recomputes all summaries from the bits, a block at a time.
+        constexpr auto rebuild() noexcept
+                -> void
+        {
+                if constexpr (has_summary) {
+                        m_summary.m_bits.clear();
+                        for (auto i = 0; i < num_blocks; ++i) {
+                                if (block(i)) {
+                                        m_summary.m_bits.add(i);
+                                }
+                        }
+                        m_summary.rebuild();
+                }
+        }
+
+        class const_iterator_impl
+        {
+        public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using difference_type   = layered_bit_set::difference_type;
+                using value_type        = layered_bit_set::value_type;
+                using pointer           = void;
+                using reference         = value_type;
+
+        private:
+                layered_bit_set const* m_ptr = nullptr;
+                value_type m_value = 0;
+
+        public:
+                const_iterator_impl() = default;
+
+                [[nodiscard]] constexpr const_iterator_impl(layered_bit_set const* p, value_type v) noexcept
+                :
+                        m_ptr(p),
+                        m_value(v)
+                {}
+
+                [[nodiscard]] constexpr auto operator==(const_iterator_impl const& other) const noexcept
+                        -> bool
+                {
+                        assert(this->m_ptr == other.m_ptr);
+                        return this->m_value == other.m_value;
+                }
+
+                [[nodiscard]] constexpr auto operator*() const noexcept
+                        -> value_type
+                {
+                        assert(m_value < M);
+                        return m_value;
+                }
+
+                constexpr auto operator++() noexcept
+                        -> const_iterator_impl&
+                {
+                        assert(m_value < M);
+                        m_value = m_ptr->find_next(m_value + 1);
+                        return *this;
+                }
+
+                constexpr auto operator++(int) noexcept
+                        -> const_iterator_impl
+                {
+                        auto nrv = *this; ++*this; return nrv;
+                }
+
+                constexpr auto operator--() noexcept
+                        -> const_iterator_impl&
+                {
+                        m_value = m_ptr->find_prev(m_value);
+                        assert(m_value >= 0);
+                        return *this;
+                }
+
+                constexpr auto operator--(int) noexcept
+                        -> const_iterator_impl
+                {
+                        auto nrv = *this; --*this; return nrv;
+                }
+        };
+};
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto operator~(layered_bit_set<N, Block> const& lhs) noexcept
+{
+        auto nrv = lhs; nrv.complement(); return nrv;
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto operator&(layered_bit_set<N, Block> const& lhs, layered_bit_set<N, Block> const& rhs) noexcept
+{
+        auto nrv = lhs; nrv &= rhs; return nrv;
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto operator|(layered_bit_set<N, Block> const& lhs, layered_bit_set<N, Block> const& rhs) noexcept
+{
+        auto nrv = lhs; nrv |= rhs; return nrv;
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto operator^(layered_bit_set<N, Block> const& lhs, layered_bit_set<N, Block> const& rhs) noexcept
+{
+        auto nrv = lhs; nrv ^= rhs; return nrv;
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto operator-(layered_bit_set<N, Block> const& lhs, layered_bit_set<N, Block> const& rhs) noexcept
+{
+        auto nrv = lhs; nrv -= rhs; return nrv;
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+constexpr auto swap(layered_bit_set<N, Block>& lhs, layered_bit_set<N, Block>& rhs) noexcept
+{
+        lhs.swap(rhs);
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto begin(layered_bit_set<N, Block> const& bs) noexcept
+{
+        return bs.begin();
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto end(layered_bit_set<N, Block> const& bs) noexcept
+{
+        return bs.end();
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto size(layered_bit_set<N, Block> const& bs) noexcept
+{
+        return bs.size();
+}
+
+template<std::size_t N, std::unsigned_integral Block>
+[[nodiscard]] constexpr auto empty(layered_bit_set<N, Block> const& bs) noexcept
+{
+        return bs.empty();
+}
+
+}       // namespace xstd
+
+#endif  // include guard
@@ -6,7 +6,6 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include <xstd/bit_set.hpp>     // bit_set
-#include <cassert>              // assert
 #include <concepts>             // unsigned_integral
 #include <cstddef>              // size_t
 #include <iosfwd>               // basic_istream, basic_ostream
@@ -53,22 +52,7 @@ public:
                 CharT one = CharT('1')
         ) noexcept(false)
         {
-                if (pos > str.size()) {
-                        throw std::out_of_range("");
-                }
-                assert(m_impl.empty());
-                auto const rlen = std::min(n, str.size() - pos);
-                auto const M = std::min(N, rlen);
-                for (auto i = std::size_t(0); i < M; ++i) {
-                        auto const ch = str[pos + M - 1 - i];
-                        if (Traits::eq(ch, one)) {
-                                m_impl.add(static_cast<int>(i));
-                        } else if (Traits::eq(ch, zero)) {
-                                assert(!m_impl.contains(static_cast<int>(i)));
-                        } else {
-                                throw std::invalid_argument("");
-                        }
-                }
+                m_impl.from_string(str, pos, n, zero, one);
         }
 
         template<class CharT>
@@ -192,13 +176,7 @@ public:
         >
         [[nodiscard]] constexpr auto to_string(CharT zero = CharT('0'), CharT one = CharT('1')) const noexcept(false)
         {
-                auto str = std::basic_string<CharT, Traits, Allocator>(N, zero);
-                for (auto i = std::size_t(0); i < N; ++i) {
-                        if (m_impl.contains(static_cast<int>(N - 1 - i))) {
-                                str[i] = one;
-                        }
-                }
-                return str;
+                return m_impl.template to_string<CharT, Traits, Allocator>(zero, one);
         }
 
         [[nodiscard]] constexpr auto count() const noexcept
@@ -7,6 +7,7 @@
 
 #include <bitset/factory.hpp>   // make_bitset
 #include <concepts.hpp>         // resizeable
+#include <shard.hpp>            // this_shard
 #include <cassert>              // assert
 #include <cstddef>              // size_t
 
@@ -23,8 +24,8 @@ inline auto const limit_v = resizeable<T> ? Limit : T().size();
 inline constexpr auto L0 = 128;
 inline constexpr auto L1 =  64;
 inline constexpr auto L2 =  32;
-inline constexpr auto L3 =  16;
-inline constexpr auto L4 =   8;
+inline constexpr auto L3 =  24;
+inline constexpr auto L4 =  24;
 
 // NOTE: these tests are O(1)
 
@@ -103,7 +104,7 @@ auto all_singleton_set_pairs(auto fun)
         }
 }
 
-// NOTE: this test is O(N^3)
+// NOTE: this test is O(N^3), and the (i, j) iterations are sharded over processes
 
 template<class T>
 auto all_singleton_set_triples(auto fun)
@@ -112,6 +113,9 @@ auto all_singleton_set_triples(auto fun)
         for (auto i = decltype(N)(0); i < N; ++i) {
                 auto bs1_i = make_bitset<T>(N); bs1_i.set(i); assert(bs1_i.count() == 1);
                 for (auto j = decltype(N)(0); j < N; ++j) {
+                        if (!this_shard().owns(static_cast<int>(i * N + j))) {
+                                continue;
+                        }
                         auto bs1_j = make_bitset<T>(N); bs1_j.set(j); assert(bs1_j.count() == 1);
                         for (auto k = decltype(N)(0); k < N; ++k) {
                                 auto bs1_k = make_bitset<T>(N); bs1_k.set(k); assert(bs1_k.count() == 1);
@@ -121,7 +125,7 @@ auto all_singleton_set_triples(auto fun)
         }
 }
 
-// NOTE: this test is O(N^4)
+// NOTE: this test is O(N^4), and the (i, j) iterations are sharded over processes
 
 template<class T>
 auto all_doubleton_set_pairs(auto fun)
@@ -129,6 +133,9 @@ auto all_doubleton_set_pairs(auto fun)
         auto const N = limit_v<T, L4>;
         for (auto j = decltype(N)(1); j < N; ++j) {
                 for (auto i = decltype(N)(0); i < j; ++i) {
+                        if (!this_shard().owns(static_cast<int>(i * N + j))) {
+                                continue;
+                        }
                         auto bs2_ij = make_bitset<T>(N); bs2_ij.set(i); bs2_ij.set(j); assert(bs2_ij.count() == 2);
                         for (auto n = decltype(N)(1); n < N; ++n) {
                                 for (auto m = decltype(N)(0); m < n; ++m) {
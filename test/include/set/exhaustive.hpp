@@ -5,6 +5,7 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <shard.hpp>            // this_shard
 #include <algorithm>            // min
 #include <array>                // array
 #include <cassert>              // assert
@@ -23,8 +24,8 @@ inline auto const limit_v = static_cast<int>(std::min(L, T().max_size()));
 
 inline constexpr auto L1 = 128;
 inline constexpr auto L2 =  64;
-inline constexpr auto L3 =  32;
-inline constexpr auto L4 =  16;
+inline constexpr auto L3 =  48;
+inline constexpr auto L4 =  32;
 
 // NOTE: these tests are O(1)
 
@@ -159,7 +160,7 @@ auto all_singleton_set_pairs(auto fun)
         }
 }
 
-// NOTE: this test is O(N^3)
+// NOTE: this test is O(N^3), and the (i, j) iterations are sharded over processes
 
 template<class T>
 auto all_singleton_set_triples(auto fun)
@@ -168,6 +169,9 @@ auto all_singleton_set_triples(auto fun)
         for (auto i = 0; i < N; ++i) {
                 auto is1_i = T({ i });
                 for (auto j = 0; j < N; ++j) {
+                        if (!this_shard().owns(i * N + j)) {
+                                continue;
+                        }
                         auto is1_j = T({ j });
                         for (auto k = 0; k < N; ++k) {
                                 auto is1_k = T({ k });
@@ -177,7 +181,7 @@ auto all_singleton_set_triples(auto fun)
         }
 }
 
-// NOTE: this test is O(N^4)
+// NOTE: this test is O(N^4), and the (i, j) iterations are sharded over processes
 
 template<class T>
 auto all_doubleton_set_pairs(auto fun)
@@ -185,6 +189,9 @@ auto all_doubleton_set_pairs(auto fun)
         auto const N = limit_v<T, L4>;
         for (auto j = 1; j < N; ++j) {
                 for (auto i = 0; i < j; ++i) {
+                        if (!this_shard().owns(i * N + j)) {
+                                continue;
+                        }
                         auto is2_ij = T({ i, j });
                         for (auto n = 1; n < N; ++n) {
                                 for (auto m = 0; m < n; ++m) {
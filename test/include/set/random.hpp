@@ -0,0 +1,46 @@
+#pragma once
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/detail/block_kernels.hpp> // active_isa, isa, is_supported
+#include <random>                        // bernoulli_distribution, mt19937
+
+namespace xstd {
+
+// Adds each of the values in [0, last) to bs with the given probability.
+auto random_fill(auto& bs, std::mt19937& gen, double density, int last)
+{
+        auto coin = std::bernoulli_distribution(density);
+        for (auto i = 0; i < last; ++i) {
+                if (coin(gen)) {
+                        bs.add(i);
+                }
+        }
+}
+
+// A set with each of its possible elements present with the given probability.
+template<class T>
+auto random_set(std::mt19937& gen, double density)
+{
+        T bs;
+        random_fill(bs, gen, density, static_cast<int>(bs.max_size()));
+        return bs;
+}
+
+// Calls fun() once for every instruction set that the host supports, with the kernels pinned to it.
+auto all_isa(auto fun)
+{
+        auto const saved = detail::active_isa();
+        for (auto i : { detail::isa::scalar, detail::isa::avx2, detail::isa::avx512 }) {
+                if (detail::is_supported(i)) {
+                        detail::active_isa() = i;
+                        fun();
+                }
+        }
+        detail::active_isa() = saved;
+}
+
+}       // namespace xstd
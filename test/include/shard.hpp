@@ -0,0 +1,73 @@
+#pragma once
+
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <charconv>     // from_chars
+#include <cstdio>       // fprintf, stderr
+#include <cstdlib>      // abort, getenv
+#include <cstring>      // strlen
+#include <system_error> // errc
+
+namespace xstd {
+
+// The share of the O(N^3) and O(N^4) exhaustive tests that this process runs. The outer loop
+// iterations are dealt round-robin over XSTD_TEST_SHARD_COUNT processes (1 if unset), of which
+// this is number XSTD_TEST_SHARD_INDEX (0 if unset). CMake registers each such test as that many
+// ctest shards, so that ctest -j runs them on all cores. Invalid values abort the process, also
+// in release builds, rather than silently running the wrong share of the tests.
+class test_shard
+{
+        int m_index = 0;
+        int m_count = 1;
+
+        [[noreturn]] static auto fail(char const* name, char const* value) noexcept
+        {
+                std::fprintf(stderr, "invalid %s=\"%s\"\n", name, value);
+                std::abort();
+        }
+
+        // The integer value of the environment variable name, or fallback if it is unset.
+        [[nodiscard]] static auto parse(char const* name, int fallback) noexcept
+        {
+                auto const value = std::getenv(name);
+                if (!value) {
+                        return fallback;
+                }
+                auto const last = value + std::strlen(value);
+                auto result = 0;
+                if (auto const [ptr, ec] = std::from_chars(value, last, result); ec != std::errc() || ptr != last) {
+                        fail(name, value);
+                }
+                return result;
+        }
+public:
+        test_shard() noexcept
+        :
+                m_index(parse("XSTD_TEST_SHARD_INDEX", 0)),
+                m_count(parse("XSTD_TEST_SHARD_COUNT", 1))
+        {
+                if (m_count < 1) {
+                        fail("XSTD_TEST_SHARD_COUNT", std::getenv("XSTD_TEST_SHARD_COUNT"));
+                }
+                if (m_index < 0 || m_count <= m_index) {
+                        fail("XSTD_TEST_SHARD_INDEX", std::getenv("XSTD_TEST_SHARD_INDEX"));
+                }
+        }
+
+        // Whether the n-th iteration of an outer loop belongs to this shard.
+        [[nodiscard]] auto owns(int n) const noexcept
+        {
+                return n % m_count == m_index;
+        }
+};
+
+inline auto const& this_shard()
+{
+        static auto const shard = test_shard();
+        return shard;
+}
+
+}       // namespace xstd
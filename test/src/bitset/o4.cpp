@@ -21,6 +21,7 @@ using namespace xstd;
 using bitset_types = boost::mpl::vector
 <       std::bitset< 0>
 ,       std::bitset<17>
+,       std::bitset<24>
 ,       boost::dynamic_bitset<>
 ,       bitset< 0, uint8_t>
 ,       bitset< 8, uint8_t>
@@ -28,6 +29,8 @@ using bitset_types = boost::mpl::vector
 ,       bitset<17, uint8_t>
 ,       bitset<17, uint16_t>
 ,       bitset<17, uint32_t>
+,       bitset<24, uint8_t>
+,       bitset<24, uint16_t>
 #if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
 ,       bitset<17, uint64_t>
 #endif
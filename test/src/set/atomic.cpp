@@ -0,0 +1,107 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/atomic_bit_set.hpp>       // atomic_bit_set
+#include <xstd/bit_set.hpp>              // bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL
+#include <atomic>                        // memory_order_relaxed
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <random>                        // mt19937, uniform_int_distribution
+#include <thread>                        // thread
+#include <type_traits>                   // is_copy_constructible_v
+#include <vector>                        // vector
+
+// An atomic_bit_set must behave as a bit_set under single-threaded updates,
+// and must not lose or duplicate any update under concurrent ones.
+
+BOOST_AUTO_TEST_SUITE(Atomic)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+template<class T>
+using atomic_type = atomic_bit_set<T::max_size(), typename T::block_type>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Sequential, T, int_set_types)
+{
+        static_assert(!std::is_copy_constructible_v<atomic_type<T>>);
+        auto gen = std::mt19937(42);
+        auto dist = std::uniform_int_distribution<int>(0, static_cast<int>(T::max_size()) - 1);
+        atomic_type<T> a;
+        T expected;
+        for (auto rep = 0; rep < 1000; ++rep) {
+                auto const x = dist(gen);
+                switch (rep % 5) {
+                case 0: a.add(x); expected.add(x); break;
+                case 1: BOOST_CHECK_EQUAL(a.insert(x), expected.insert(x).second); break;
+                case 2: a.pop(x, std::memory_order_relaxed); expected.pop(x); break;
+                case 3: BOOST_CHECK_EQUAL(a.erase(x), expected.erase(x)); break;
+                case 4: a.replace(x); expected.replace(x); break;
+                }
+                BOOST_CHECK_EQUAL(a.contains(x), expected.contains(x));
+        }
+        BOOST_CHECK(a.snapshot() == expected);
+        BOOST_CHECK(atomic_type<T>(expected).snapshot() == expected);
+        a.clear();
+        BOOST_CHECK(a.snapshot().empty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Concurrent, T, int_set_types)
+{
+        // every thread inserts every element (11 is coprime with all N), and each element is newly inserted exactly once
+        constexpr auto N = static_cast<int>(T::max_size());
+        constexpr auto num_threads = 4;
+        atomic_type<T> a;
+        std::vector<int> inserted(num_threads);
+        {
+                std::vector<std::thread> threads;
+                for (auto t = 0; t < num_threads; ++t) {
+                        threads.emplace_back([&, t] {
+                                for (auto i = 0; i < N; ++i) {
+                                        inserted[static_cast<std::size_t>(t)] += a.insert((i * 11 + t) % N);
+                                }
+                        });
+                }
+                for (auto& thread : threads) {
+                        thread.join();
+                }
+        }
+        auto total = 0;
+        for (auto n : inserted) {
+                total += n;
+        }
+        BOOST_CHECK_EQUAL(total, N);
+        BOOST_CHECK(a.snapshot() == ~T());
+
+        // every thread flips the elements with its own residue, sharing blocks with the others
+        {
+                std::vector<std::thread> threads;
+                for (auto t = 0; t < num_threads; ++t) {
+                        threads.emplace_back([&, t] {
+                                for (auto i = t; i < N; i += num_threads) {
+                                        a.replace(i, std::memory_order_relaxed);
+                                }
+                        });
+                }
+                for (auto& thread : threads) {
+                        thread.join();
+                }
+        }
+        BOOST_CHECK(a.snapshot().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // all_isa, random_set
+#include <xstd/bit_set.hpp>              // bit_set, intersection_size
+#include <xstd/bit_set_batch.hpp>        // intersection_size, intersects, is_subset_of
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK_EQUAL
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <random>                        // mt19937
+#include <vector>                        // vector
+
+// The one-vs-many queries must agree with the member calls on every candidate,
+// for every instruction set that the host supports.
+
+BOOST_AUTO_TEST_SUITE(Batch)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<  300, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 1024, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+// Candidates around the query: random ones, and supersets and subsets of it.
+template<class T>
+auto random_candidates(std::mt19937& gen, T const& query, int m)
+{
+        auto nrv = std::vector<T>();
+        for (auto j = 0; j < m; ++j) {
+                auto const density = (j % 5) / 4.0;
+                switch (j % 3) {
+                case 0: nrv.push_back(random_set<T>(gen, density)); break;
+                case 1: nrv.push_back(query | random_set<T>(gen, density / 8)); break;
+                default: nrv.push_back(query & random_set<T>(gen, density)); break;
+                }
+        }
+        return nrv;
+}
+
+template<class OutBlock, class T>
+auto check_batch(T const& query, std::vector<T> const& candidates)
+{
+        auto const m = candidates.size();
+        auto is = dynamic_bit_set<OutBlock>(m);
+        auto ss = dynamic_bit_set<OutBlock>(m);
+        auto sizes = std::vector<std::size_t>(m, 42);
+        intersects(query, candidates, is);
+        is_subset_of(query, candidates, ss);
+        intersection_size(query, candidates, sizes);
+        for (auto j = std::size_t(0); j < m; ++j) {
+                auto const x = static_cast<int>(j);
+                BOOST_CHECK_EQUAL(is.contains(x), query.intersects(candidates[j]));
+                BOOST_CHECK_EQUAL(ss.contains(x), query.is_subset_of(candidates[j]));
+                BOOST_CHECK_EQUAL(sizes[j], intersection_size(query, candidates[j]));
+        }
+        BOOST_CHECK_EQUAL(is.size() + (~is).size(), m);
+        BOOST_CHECK_EQUAL(ss.size() + (~ss).size(), m);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(OneVersusMany, T, int_set_types)
+{
+        all_isa([] {
+                auto gen = std::mt19937(42);
+                for (auto density : { 0.0, 0.01, 0.5, 1.0 }) {
+                        auto const query = random_set<T>(gen, density);
+                        for (auto m : { 0, 1, 63, 64, 203 }) {
+                                auto const candidates = random_candidates<T>(gen, query, m);
+                                check_batch<uint8_t>(query, candidates);
+                                check_batch<std::size_t>(query, candidates);
+                        }
+                }
+        });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
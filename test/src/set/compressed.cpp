@@ -0,0 +1,221 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/compressed_bit_set.hpp>   // compressed_bit_set
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <algorithm>                     // all_of, lexicographical_compare_three_way, includes, set_difference, set_intersection, set_symmetric_difference, set_union, sort, unique
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint32_t
+#include <iterator>                      // back_inserter, bidirectional_iterator, next, prev
+#include <random>                        // mt19937, uniform_int_distribution
+#include <ranges>                        // bidirectional_range, istream
+#include <sstream>                       // stringstream
+#include <vector>                        // vector
+
+// A compressed_bit_set must behave as a sorted std::vector<std::uint32_t> of unique values,
+// for every pair of chunk representations.
+
+BOOST_AUTO_TEST_SUITE(Compressed)
+
+using namespace xstd;
+
+using values = std::vector<std::uint32_t>;
+
+enum kind : std::size_t { array, bitmap, runs };
+
+auto kinds(compressed_bit_set const& bs)
+{
+        return detail::compressed_bit_set_access::kinds(bs);
+}
+
+// Values with the upper 16 bits equal to each of the keys, drawn so as to make chunks of the given kind.
+auto make_values(kind k, std::vector<std::uint32_t> const& keys, std::mt19937& gen)
+{
+        auto low = std::uniform_int_distribution<std::uint32_t>(0, 65535);
+        values v;
+        for (auto key : keys) {
+                auto const base = key << 16;
+                switch (k) {
+                case array:
+                        for (auto i = 0; i < 1000; ++i) {
+                                v.push_back(base | low(gen));
+                        }
+                        break;
+                case bitmap:
+                        for (auto i = 0; i < 40000; ++i) {
+                                v.push_back(base | low(gen));
+                        }
+                        break;
+                case runs:
+                        for (auto i = 0; i < 20; ++i) {
+                                auto const first = low(gen) % 64000;
+                                for (auto x = first; x < first + 1000; ++x) {
+                                        v.push_back(base | x);
+                                }
+                        }
+                        break;
+                }
+        }
+        std::ranges::sort(v);
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        return v;
+}
+
+auto check_equal(compressed_bit_set const& bs, values const& v)
+{
+        BOOST_CHECK_EQUAL(bs.size(), v.size());
+        BOOST_CHECK_EQUAL(bs.empty(), v.empty());
+        BOOST_CHECK_EQUAL_COLLECTIONS(bs.begin(), bs.end(), v.begin(), v.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(bs.rbegin(), bs.rend(), v.rbegin(), v.rend());
+        BOOST_CHECK(bs == compressed_bit_set(v.begin(), v.end()));
+}
+
+BOOST_AUTO_TEST_CASE(ChunkPairs)
+{
+        static_assert(std::bidirectional_iterator<compressed_bit_set::iterator>);
+        static_assert(std::ranges::bidirectional_range<compressed_bit_set>);
+
+        auto gen = std::mt19937(42);
+        for (auto kl : { array, bitmap, runs }) {
+                for (auto kr : { array, bitmap, runs }) {
+                        // keys 0 and 7 are shared, the others are one-sided
+                        auto const l = make_values(kl, { 0, 2, 7 }, gen);
+                        auto const r = make_values(kr, { 0, 5, 7, 65535 }, gen);
+                        auto const a = compressed_bit_set(l.begin(), l.end());
+                        auto const b = compressed_bit_set(r.begin(), r.end());
+                        BOOST_CHECK(std::ranges::all_of(kinds(a), [=](auto x) { return x == kl; }));
+                        BOOST_CHECK(std::ranges::all_of(kinds(b), [=](auto x) { return x == kr; }));
+                        check_equal(a, l);
+                        check_equal(b, r);
+
+                        values expected;
+                        std::ranges::set_intersection(l, r, std::back_inserter(expected));
+                        check_equal(a & b, expected);
+                        BOOST_CHECK_EQUAL(a.intersects(b), !expected.empty());
+
+                        expected.clear();
+                        std::ranges::set_union(l, r, std::back_inserter(expected));
+                        check_equal(a | b, expected);
+
+                        expected.clear();
+                        std::ranges::set_symmetric_difference(l, r, std::back_inserter(expected));
+                        check_equal(a ^ b, expected);
+
+                        expected.clear();
+                        std::ranges::set_difference(l, r, std::back_inserter(expected));
+                        check_equal(a - b, expected);
+
+                        BOOST_CHECK_EQUAL(a == b, l == r);
+                        BOOST_CHECK((a <=> b) == (l <=> r));
+                        BOOST_CHECK_EQUAL(a.is_subset_of(b), std::ranges::includes(r, l));
+                        BOOST_CHECK((a & b).is_subset_of(b));
+                        BOOST_CHECK((a & b).is_proper_subset_of(a | b));
+                        BOOST_CHECK(!(a | b).is_subset_of(a & b));
+                        check_equal(a ^ a, {});
+                        check_equal(a & a, l);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(Representation)
+{
+        compressed_bit_set bs;
+        for (auto i = 0u; i <= 4096; ++i) {
+                bs.insert(3 * i);
+        }
+        BOOST_CHECK(kinds(bs) == std::vector<std::size_t>{ bitmap });
+        bs.erase(0u);
+        BOOST_CHECK(kinds(bs) == std::vector<std::size_t>{ array });
+
+        // single insertions only convert an array when it overflows, bulk insertion re-picks
+        bs.clear();
+        auto v = values();
+        for (auto i = 0u; i < 65536; ++i) {
+                bs.insert(i);
+                v.push_back(i);
+        }
+        BOOST_CHECK(kinds(bs) == std::vector<std::size_t>{ bitmap });
+        bs.clear();
+        bs.insert(v.begin(), v.end());
+        BOOST_CHECK_EQUAL(bs.size(), std::size_t(65536));
+        BOOST_CHECK(kinds(bs) == std::vector<std::size_t>{ runs });
+
+        // splitting a run into more runs than fit in a bitmap re-picks the representation
+        for (auto i = 1u; i < 65536; i += 2) {
+                bs.erase(i);
+        }
+        BOOST_CHECK_EQUAL(bs.size(), std::size_t(32768));
+        BOOST_CHECK(kinds(bs) == std::vector<std::size_t>{ bitmap });
+
+        v.clear();
+        for (auto i = 0u; i < 100000; ++i) {
+                v.push_back(i);
+        }
+        BOOST_CHECK(kinds(compressed_bit_set(v.begin(), v.end())) == (std::vector<std::size_t>{ runs, runs }));
+}
+
+BOOST_AUTO_TEST_CASE(Elements)
+{
+        auto gen = std::mt19937(42);
+        auto v = make_values(runs, { 1, 2 }, gen);
+        auto const w = make_values(array, { 9, 65535 }, gen);
+        v.insert(v.end(), w.begin(), w.end());
+        v.push_back(0xFFFF'FFFF);
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        auto bs = compressed_bit_set(v.begin(), v.end());
+        check_equal(bs, v);
+        BOOST_CHECK_EQUAL(bs.front(), v.front());
+        BOOST_CHECK_EQUAL(bs.back(), 0xFFFF'FFFFu);
+        BOOST_CHECK_EQUAL(compressed_bit_set::max_size(), std::size_t(1) << 32);
+
+        // single-pass input ranges are consumed exactly once
+        auto in = std::stringstream();
+        for (auto x : v) {
+                in << x << ' ';
+        }
+        auto cs = compressed_bit_set();
+        cs.insert_range(std::views::istream<std::uint32_t>(in));
+        check_equal(cs, v);
+
+        auto const value = [&](auto it) {
+                return it == bs.end() ? std::size_t(1) << 32 : std::size_t(*it);
+        };
+        auto const expected = [&](auto it) {
+                return it == v.end() ? std::size_t(1) << 32 : std::size_t(*it);
+        };
+        auto probe = std::uniform_int_distribution<std::uint32_t>(0, 10 << 16);
+        for (auto i = 0; i < 10000; ++i) {
+                auto const x = i < 5000 ? probe(gen) : v[static_cast<std::size_t>(i) % v.size()];
+                BOOST_CHECK_EQUAL(bs.contains(x), std::ranges::binary_search(v, x));
+                BOOST_CHECK_EQUAL(value(bs.lower_bound(x)), expected(std::ranges::lower_bound(v, x)));
+                BOOST_CHECK_EQUAL(value(bs.upper_bound(x)), expected(std::ranges::upper_bound(v, x)));
+                BOOST_CHECK(bs.find(x) == (bs.contains(x) ? bs.lower_bound(x) : bs.end()));
+        }
+        BOOST_CHECK(bs.upper_bound(0xFFFF'FFFF) == bs.end());
+
+        auto const sum = bs.for_each([n = std::size_t(0)](auto x) mutable { return n += x; })(0u);
+        auto expected_sum = std::size_t(0);
+        for (auto x : v) {
+                expected_sum += x;
+        }
+        BOOST_CHECK_EQUAL(sum, expected_sum);
+        BOOST_CHECK(bs.to_vector() == v);
+
+        // erase an iterator range crossing chunk boundaries
+        auto const i = v.size() / 4;
+        auto const j = 3 * v.size() / 4;
+        auto const next = bs.erase(std::next(bs.begin(), static_cast<std::ptrdiff_t>(i)), std::next(bs.begin(), static_cast<std::ptrdiff_t>(j)));
+        BOOST_CHECK_EQUAL(*next, v[j]);
+        v.erase(v.begin() + static_cast<std::ptrdiff_t>(i), v.begin() + static_cast<std::ptrdiff_t>(j));
+        check_equal(bs, v);
+
+        for (auto x : values(v)) {
+                BOOST_CHECK_EQUAL(bs.erase(x), std::size_t(1));
+                BOOST_CHECK_EQUAL(bs.erase(x), std::size_t(0));
+        }
+        BOOST_CHECK(bs.empty() && bs.begin() == bs.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
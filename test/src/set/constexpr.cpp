@@ -6,9 +6,10 @@
 #define BOOST_MPL_CFG_NO_PREPROCESSED_HEADERS
 #define BOOST_MPL_LIMIT_VECTOR_SIZE 50
 
-#include <xstd/bit_set.hpp>             // bit_set
+#include <xstd/bit_set.hpp>             // bit_set, difference_size, intersection_size, jaccard_index, symmetric_difference_size, union_size
 #include <boost/mpl/vector.hpp>         // vector
 #include <boost/test/unit_test.hpp>     // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <algorithm>                    // equal
 #include <compare>                      // strong_ordering
 
 BOOST_AUTO_TEST_SUITE(Constexpr)
@@ -64,6 +65,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(Empty, T, int_set_types)
         static_assert(b.empty());
         static_assert(b.size() == 0);
         static_assert(b.begin() == b.end());
+        static_assert(b.to_vector().empty());
         static_assert(b == b);
         static_assert((b <=> b) == std::strong_ordering::equal);
 }
@@ -75,8 +77,25 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(Full, T, int_set_types)
         static_assert(b.size() == b.max_size());
         static_assert(b.empty() || b.front() == *b.cbegin());
         static_assert(b.empty() || b.back() == *b.crbegin());
+        static_assert(std::ranges::equal(b.to_vector(), b));
         static_assert(b == b);
         static_assert((b <=> b) == std::strong_ordering::equal);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(Counting, T, int_set_types)
+{
+        constexpr auto e = T();
+        constexpr auto f = ~T();
+        static_assert(intersection_size(e, f) == 0);
+        static_assert(intersection_size(f, f) == f.size());
+        static_assert(union_size(e, f) == f.size());
+        static_assert(difference_size(f, e) == f.size());
+        static_assert(difference_size(e, f) == 0);
+        static_assert(symmetric_difference_size(e, f) == f.size());
+        static_assert(symmetric_difference_size(f, f) == 0);
+        static_assert(jaccard_index(e, e) == 1.0);
+        static_assert(jaccard_index(f, f) == 1.0);
+        static_assert(f.empty() || jaccard_index(e, f) == 0.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,217 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set, difference_size, intersection_size, jaccard_index, symmetric_difference_size, union_size
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set, difference_size, intersection_size, jaccard_index, symmetric_difference_size, union_size
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS, BOOST_CHECK_THROW
+#include <algorithm>                     // max
+#include <concepts>                      // same_as
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // bidirectional_iterator, next
+#include <limits>                        // numeric_limits
+#include <memory>                        // allocator
+#include <random>                        // mt19937
+#include <ranges>                        // bidirectional_range, istream
+#include <sstream>                       // stringstream
+#include <stdexcept>                     // length_error
+#include <utility>                       // move
+
+// A dynamic_bit_set must behave as the bit_set of the same max_size and block type.
+
+BOOST_AUTO_TEST_SUITE(Dynamic)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<   16, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set<  100, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+template<class T>
+using dynamic_type = dynamic_bit_set<typename T::block_type>;
+
+template<class T>
+auto to_dynamic(T const& bs)
+{
+        auto const v = bs.to_vector();
+        return dynamic_type<T>(T::max_size(), v.begin(), v.end());
+}
+
+template<class T>
+auto check_equal(dynamic_type<T> const& d, T const& bs)
+{
+        BOOST_CHECK_EQUAL(d.max_size(), T::max_size());
+        BOOST_CHECK_EQUAL(d.size(), bs.size());
+        BOOST_CHECK_EQUAL(d.empty(), bs.empty());
+        BOOST_CHECK_EQUAL(d.full(), bs.full());
+        BOOST_CHECK_EQUAL_COLLECTIONS(d.begin(), d.end(), bs.begin(), bs.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(d.rbegin(), d.rend(), bs.rbegin(), bs.rend());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Interface, T, int_set_types)
+{
+        using D = dynamic_type<T>;
+        static_assert(std::bidirectional_iterator<typename D::iterator>);
+        static_assert(std::ranges::bidirectional_range<D>);
+        static_assert(std::same_as<typename D::allocator_type, std::allocator<typename T::block_type>>);
+
+        auto const N = static_cast<int>(T::max_size());
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.01, 0.5, 0.99, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 1.0 - density / 2);
+                auto const da = to_dynamic(a);
+                auto const db = to_dynamic(b);
+                check_equal(da, a);
+
+                check_equal(~da, ~a);
+                check_equal(da & db, a & b);
+                check_equal(da | db, a | b);
+                check_equal(da ^ db, a ^ b);
+                check_equal(da - db, a - b);
+                BOOST_CHECK_EQUAL(da == db, a == b);
+                BOOST_CHECK((da <=> db) == (a <=> b));
+                BOOST_CHECK_EQUAL(da.is_subset_of(db), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(da.is_proper_subset_of(db), a.is_proper_subset_of(b));
+                BOOST_CHECK_EQUAL(da.intersects(db), a.intersects(b));
+                BOOST_CHECK_EQUAL(intersection_size(da, db), intersection_size(a, b));
+                BOOST_CHECK_EQUAL(union_size(da, db), union_size(a, b));
+                BOOST_CHECK_EQUAL(difference_size(da, db), difference_size(a, b));
+                BOOST_CHECK_EQUAL(symmetric_difference_size(da, db), symmetric_difference_size(a, b));
+                BOOST_CHECK_EQUAL(jaccard_index(da, db), jaccard_index(a, b));
+
+                auto const decoded = da.to_vector();
+                BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(), a.begin(), a.end());
+                auto sum = 0;
+                da.for_each([&](auto x) { sum += x; });
+                BOOST_CHECK_EQUAL(sum, a.for_each([n = 0](auto x) mutable { return n += x; })(0));
+
+                auto in = std::stringstream();
+                for (auto x : a) {
+                        in << x << ' ';
+                }
+                auto dd = D(T::max_size());
+                dd.insert_range(std::views::istream<int>(in));
+                check_equal(dd, a);
+
+                auto const value = [=](auto const& bs, auto it) {
+                        return it == bs.end() ? N : *it;
+                };
+                for (auto i = 0; i < N; ++i) {
+                        BOOST_CHECK_EQUAL(da.contains(i), a.contains(i));
+                        BOOST_CHECK_EQUAL(value(da, da.lower_bound(i)), value(a, a.lower_bound(i)));
+                        BOOST_CHECK_EQUAL(value(da, da.upper_bound(i)), value(a, a.upper_bound(i)));
+                        BOOST_CHECK((da << i) == to_dynamic(a << i));
+                        BOOST_CHECK((da >> i) == to_dynamic(a >> i));
+                }
+                auto const step = std::max(1, N / 32);
+                for (auto first = 0; first <= N; first += step) {
+                        for (auto last = first; last <= N; last += step) {
+                                BOOST_CHECK_EQUAL(da.count(first, last), a.count(first, last));
+                                BOOST_CHECK_EQUAL(da.contains_any(first, last), a.contains_any(first, last));
+                                BOOST_CHECK_EQUAL(da.contains_all(first, last), a.contains_all(first, last));
+                                auto di = da; di.insert(first, last);
+                                auto ai = a;  ai.insert(first, last);
+                                BOOST_CHECK(di == to_dynamic(ai));
+                                auto de = da; de.erase(first, last);
+                                auto ae = a;  ae.erase(first, last);
+                                BOOST_CHECK(de == to_dynamic(ae));
+                        }
+                }
+
+                auto dc = da;
+                dc.fill();
+                check_equal(dc, ~T());
+                dc.clear();
+                check_equal(dc, T());
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Resize, T, int_set_types)
+{
+        auto const N = static_cast<int>(T::max_size());
+        auto gen = std::mt19937(42);
+        auto const a = random_set<T>(gen, 0.5);
+        for (auto n : { 0, 1, N / 3, N - 1, N, N + 1, 2 * N + 100 }) {
+                if (n < 0) {
+                        continue;
+                }
+                auto d = to_dynamic(a);
+                d.resize(static_cast<std::size_t>(n));
+                BOOST_CHECK_EQUAL(d.max_size(), static_cast<std::size_t>(n));
+                BOOST_CHECK(d.size() <= d.max_size() && d.max_size() <= d.capacity());
+                auto expected = a;
+                if (n < N) {
+                        expected.erase(n, N);
+                }
+                BOOST_CHECK_EQUAL_COLLECTIONS(d.begin(), d.end(), expected.begin(), expected.end());
+                if (n > 0) {
+                        d.fill();
+                        BOOST_CHECK_EQUAL(d.size(), static_cast<std::size_t>(n));
+                        BOOST_CHECK_EQUAL(d.back(), n - 1);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(ResizeInPlace)
+{
+        auto d = dynamic_bit_set<uint64_t>(100, { 0, 63, 64, 99 });
+        d.reserve(1000);
+        auto const capacity = d.capacity();
+        BOOST_CHECK(capacity >= 1000);
+        for (auto n : { 1000, 64, 999, 100, 65 }) {
+                d.resize(static_cast<std::size_t>(n));
+                BOOST_CHECK_EQUAL(d.capacity(), capacity);
+        }
+        BOOST_CHECK(d == dynamic_bit_set<uint64_t>(65, { 0, 63 }));
+
+        auto e = std::move(d);
+        BOOST_CHECK(e == dynamic_bit_set<uint64_t>(65, { 0, 63 }));
+        BOOST_CHECK_EQUAL(d.max_size(), std::size_t(0));
+        BOOST_CHECK(d.empty() && d.begin() == d.end());
+        d = e;
+        swap(d, e);
+        BOOST_CHECK(d == e);
+}
+
+BOOST_AUTO_TEST_CASE(LengthError)
+{
+        using D = dynamic_bit_set<uint64_t>;
+        constexpr auto too_large = static_cast<std::size_t>(std::numeric_limits<int>::max()) + 1;
+        BOOST_CHECK_THROW(static_cast<void>(D(too_large)), std::length_error);
+        BOOST_CHECK_THROW(static_cast<void>(D::num_blocks(too_large)), std::length_error);
+
+        // the check comes before any allocation, so the set is left unchanged
+        auto d = D(100, { 0, 63, 99 });
+        BOOST_CHECK_THROW(d.reserve(too_large), std::length_error);
+        BOOST_CHECK_THROW(d.resize(too_large), std::length_error);
+        BOOST_CHECK(d == D(100, { 0, 63, 99 }));
+}
+
+BOOST_AUTO_TEST_CASE(Constexpr)
+{
+        static_assert([] {
+                auto a = dynamic_bit_set<uint8_t>(20, { 0, 1, 9, 19 });
+                auto const b = ~a;
+                auto const disjoint = (b & a).empty();
+                a.resize(10);
+                return disjoint && a.size() == 3 && a.back() == 9 && b.size() == 16 && *std::next(b.begin(), 2) == 4;
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
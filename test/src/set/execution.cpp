@@ -0,0 +1,149 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_fill
+#include <xstd/bit_set.hpp>              // bit_set, heap_storage, intersection_size
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set, intersection_size
+#include <xstd/execution.hpp>            // and_assign, balanced_chunks, for_each, intersection_size, intersects, is_subset_of, minus_assign, or_assign, parallel_policy, size, ssize, xor_assign
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL
+#include <atomic>                        // atomic, memory_order_relaxed
+#include <concepts>                      // unsigned_integral
+#include <cstddef>                       // ptrdiff_t, size_t
+#include <cstdint>                       // uint8_t, uint32_t, uint64_t
+#include <random>                        // mt19937
+#include <vector>                        // vector
+
+// The parallel overloads must agree with the operators and members of the same name,
+// for every number of threads, including sets too small to be split.
+
+BOOST_AUTO_TEST_SUITE(Execution)
+
+using namespace xstd;
+
+template<std::unsigned_integral Block>
+struct dynamic_set
+{
+        using block_type = Block;
+        std::size_t n;
+        auto make() const { return dynamic_bit_set<Block>(n); }
+};
+
+template<class T>
+struct fixed_set
+{
+        using block_type = typename T::block_type;
+        auto make() const { return T(); }
+};
+
+using int_set_types = boost::mpl::vector
+<       fixed_set<bit_set<  200, uint8_t>>
+,       fixed_set<bit_set<(1 << 22) + 13, uint32_t, heap_storage>>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       fixed_set<bit_set<(1 << 23), uint64_t, heap_storage>>
+#endif
+,       dynamic_set<uint8_t>
+,       dynamic_set<uint64_t>
+>;
+
+// well below the default, so that the sets above are split into as many chunks as threads
+inline constexpr auto min_chunk_bytes = std::size_t(1) << 12;
+
+template<class F>
+auto factories()
+{
+        if constexpr (requires(F f) { f.n; }) {
+                return std::vector<F>{ F{ 0 }, F{ 1000 }, F{ (1 << 22) + 7 } };
+        } else {
+                return std::vector<F>{ F{} };
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Algebra, F, int_set_types)
+{
+        auto gen = std::mt19937(42);
+        for (auto const& factory : factories<F>()) {
+                for (auto density : { 0.0, 0.01, 0.5, 1.0 }) {
+                        auto a = factory.make();
+                        auto b = factory.make();
+                        random_fill(a, gen, density, static_cast<int>(a.max_size()));
+                        random_fill(b, gen, 0.5, static_cast<int>(b.max_size()));
+                        auto const sub = a & b;
+                        for (auto num_threads : { 1, 3, 4, 16 }) {
+                                auto const policy = execution::parallel_policy(num_threads, min_chunk_bytes);
+                                BOOST_CHECK_EQUAL(ssize(policy, a), a.ssize());
+                                BOOST_CHECK_EQUAL(size(policy, b), b.size());
+                                BOOST_CHECK_EQUAL(intersection_size(policy, a, b), intersection_size(a, b));
+                                BOOST_CHECK_EQUAL(is_subset_of(policy, a, b), a.is_subset_of(b));
+                                BOOST_CHECK(is_subset_of(policy, sub, a));
+                                BOOST_CHECK_EQUAL(intersects(policy, a, b), a.intersects(b));
+
+                                auto c = a; BOOST_CHECK(and_assign(policy, c, b) == (a & b));
+                                c = a; BOOST_CHECK(or_assign(policy, c, b) == (a | b));
+                                c = a; BOOST_CHECK(xor_assign(policy, c, b) == (a ^ b));
+                                c = a; BOOST_CHECK(minus_assign(policy, c, b) == (a - b));
+                        }
+                        BOOST_CHECK_EQUAL(ssize(execution::par, a), a.ssize());
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ForEach, F, int_set_types)
+{
+        auto gen = std::mt19937(42);
+        for (auto const& factory : factories<F>()) {
+                for (auto density : { 0.0, 0.01, 0.5, 1.0 }) {
+                        // all elements of the sparse sets are in the first tenth of the range
+                        auto a = factory.make();
+                        auto const N = static_cast<int>(a.max_size());
+                        random_fill(a, gen, density, density < 1.0 ? N / 10 : N);
+                        for (auto num_threads : { 1, 3, 16 }) {
+                                std::vector<std::atomic<int>> hits(a.max_size());
+                                for_each(execution::parallel_policy(num_threads, min_chunk_bytes), a, [&](int x) {
+                                        hits[static_cast<std::size_t>(x)].fetch_add(1, std::memory_order_relaxed);
+                                });
+                                auto num_wrong = 0;
+                                for (auto i = 0; i < static_cast<int>(a.max_size()); ++i) {
+                                        num_wrong += hits[static_cast<std::size_t>(i)].load() != static_cast<int>(a.contains(i));
+                                }
+                                BOOST_CHECK_EQUAL(num_wrong, 0);
+                        }
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(BalancedChunks)
+{
+        // a skewed distribution of elements over groups still gives chunks of about equal counts
+        std::vector<std::ptrdiff_t> counts(1000, 0);
+        for (auto g = 0; g < 100; ++g) {
+                counts[static_cast<std::size_t>(g)] = 64;
+        }
+        auto const chunks = detail::balanced_chunks(counts, 10);
+        BOOST_CHECK_EQUAL(chunks.size(), 11u);
+        BOOST_CHECK_EQUAL(chunks.front(), 0u);
+        BOOST_CHECK_EQUAL(chunks.back(), counts.size());
+        for (auto c = std::size_t(0); c + 1 < 10; ++c) {
+                BOOST_CHECK_EQUAL(chunks[c + 1] - chunks[c], 10u);
+        }
+        BOOST_CHECK(detail::balanced_chunks(std::vector<std::ptrdiff_t>(5, 0), 4) == (std::vector<std::size_t>{ 0, 5 }));
+        BOOST_CHECK(detail::balanced_chunks(std::vector<std::ptrdiff_t>(), 4) == std::vector<std::size_t>{ 0 });
+}
+
+BOOST_AUTO_TEST_CASE(Nested)
+{
+        // a call from within a parallel call finds the shared pool busy and runs on its own thread
+        auto const policy = execution::parallel_policy(4, min_chunk_bytes);
+        auto a = dynamic_bit_set<uint64_t>(std::size_t(1) << 18);
+        a.fill();
+        auto const b = dynamic_bit_set<uint64_t>(std::size_t(1) << 18, { 0, 1 << 15, 2 << 15, 3 << 15, 4 << 15, 5 << 15, 6 << 15, 7 << 15 });
+        std::atomic<std::ptrdiff_t> total = 0;
+        for_each(policy, b, [&](int) {
+                total.fetch_add(ssize(policy, a), std::memory_order_relaxed);
+        });
+        BOOST_CHECK_EQUAL(total.load(), 8 * a.ssize());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
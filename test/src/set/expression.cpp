@@ -0,0 +1,89 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set, lazy
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // forward_iterator, next
+#include <random>                        // mt19937
+#include <ranges>                        // forward_range
+#include <utility>                       // declval
+
+// Lazy expressions must give the same results as the eager operators they fuse.
+
+BOOST_AUTO_TEST_SUITE(Expression)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    5, uint8_t>
+,       bit_set<   16, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set< 1000, uint16_t>
+,       bit_set< 4095, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<  100, uint64_t>
+,       bit_set<16383, uint64_t>
+#endif
+>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Fusion, T, int_set_types)
+{
+        using expr_type = decltype(lazy(std::declval<T const&>()) & std::declval<T const&>());
+        static_assert(std::forward_iterator<typename expr_type::iterator>);
+        static_assert(std::ranges::forward_range<expr_type>);
+
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.01, 0.5, 0.99, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.5);
+                auto const c = random_set<T>(gen, 1.0 - density);
+                auto const d = random_set<T>(gen, density / 2);
+
+                auto const eager = (a & b) | (c - d);
+                auto const expr  = (lazy(a) & b) | (lazy(c) - d);
+                T const fused = expr;
+                BOOST_CHECK(fused == eager);
+                BOOST_CHECK(expr == eager);
+                BOOST_CHECK(eager == expr);
+                BOOST_CHECK(expr == lazy(eager));
+                BOOST_CHECK((expr <=> eager) == 0);
+                BOOST_CHECK((lazy(a) <=> b) == (a <=> b));
+                BOOST_CHECK((b <=> lazy(a)) == (b <=> a));
+                BOOST_CHECK_EQUAL(expr.ssize(), eager.ssize());
+                BOOST_CHECK_EQUAL(expr.size(), eager.size());
+                BOOST_CHECK_EQUAL(expr.empty(), eager.empty());
+                BOOST_CHECK_EQUAL_COLLECTIONS(expr.begin(), expr.end(), eager.begin(), eager.end());
+
+                T x;
+                x = ~(lazy(a) ^ ~lazy(b)) - ~c;
+                BOOST_CHECK(x == (~(a ^ ~b) - ~c));
+                BOOST_CHECK(~lazy(a) == ~a);
+                BOOST_CHECK((~~lazy(a)).ssize() == a.ssize());
+
+                auto y = a;
+                y = (lazy(y) | b) & ~lazy(y);   // blockwise evaluation makes aliasing safe
+                BOOST_CHECK(y == (b - a));
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Constexpr, T, int_set_types)
+{
+        if constexpr (T::max_size() > 5) {
+                constexpr auto a = T({ 0, 1, 2, 3, 4 });
+                constexpr auto b = ~T();
+                static_assert(T(lazy(a) & b) == (a & b));
+                static_assert((lazy(a) | b) == (a | b));
+                static_assert((~lazy(a) ^ b) == a);
+                static_assert((lazy(b) - a).size() == b.size() - a.size());
+                static_assert((lazy(a) & ~lazy(a)).empty());
+                static_assert(*std::next((lazy(a) | a).begin(), 4) == 4 && *(lazy(b) - a).begin() == 5);
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
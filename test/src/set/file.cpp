@@ -0,0 +1,145 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set
+#include <xstd/bit_set_file.hpp>         // bit_set_writer, mapped_bit_set, save
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS, BOOST_CHECK_NO_THROW, BOOST_CHECK_THROW
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <filesystem>                    // file_size, path, remove, resize_file, temp_directory_path
+#include <fstream>                       // fstream
+#include <ios>                           // ios_base
+#include <random>                        // mt19937
+#include <stdexcept>                     // runtime_error
+#include <string>                        // string
+#include <system_error>                  // system_error
+#include <vector>                        // vector
+
+// A set written to a file must be read back unchanged through a mapping of that file, on the
+// systems that support mapped_bit_set.
+
+BOOST_AUTO_TEST_SUITE(File)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+auto temp_path(char const* name)
+{
+        return std::filesystem::temp_directory_path() / (std::string("xstd_set_file_") + name + ".bits");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(RoundTrip, T, int_set_types)
+{
+        using block = typename T::block_type;
+        auto const path = temp_path("round_trip");
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                save(path, a);
+                BOOST_CHECK_EQUAL(std::filesystem::file_size(path), 64 + dynamic_bit_set<block>::num_blocks(T::max_size()) * sizeof(block));
+#if XSTD_BIT_SET_FILE_MMAP
+                {
+                        auto const m = mapped_bit_set<block>(path);
+                        BOOST_CHECK_EQUAL(m->max_size(), T::max_size());
+                        BOOST_CHECK_EQUAL(m->size(), a.size());
+                        BOOST_CHECK_EQUAL_COLLECTIONS(m->begin(), m->end(), a.begin(), a.end());
+                        BOOST_CHECK_EQUAL_COLLECTIONS(m->rbegin(), m->rend(), a.rbegin(), a.rend());
+                }
+
+                auto const v = a.to_vector();
+                auto const d = dynamic_bit_set<block>(T::max_size(), v.begin(), v.end());
+                save(path, d);
+                auto const m = mapped_bit_set<block>(path);
+                BOOST_CHECK_EQUAL(m->max_size(), d.max_size());
+                BOOST_CHECK(m->to_vector() == v);
+#endif
+        }
+        std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(Writer)
+{
+        // more blocks than fit in the window of the writer, with long runs of zero blocks
+        constexpr auto N = 1 << 21;
+        auto const path = temp_path("writer");
+        auto expected = std::vector<int>();
+        {
+                auto writer = bit_set_writer<uint64_t>(path, N);
+                for (auto x = 5; x < N / 2; x += 997) {
+                        writer.insert(x);
+                        expected.push_back(x);
+                }
+                writer.insert_block(N / 128, 0x8000'0000'0000'0001);
+                expected.push_back(N / 2);
+                expected.push_back(N / 2 + 63);
+                writer.insert(N - 1);
+                expected.push_back(N - 1);
+                writer.close();
+        }
+        BOOST_CHECK_EQUAL(std::filesystem::file_size(path), 64u + N / 8u);
+#if XSTD_BIT_SET_FILE_MMAP
+        auto const m = mapped_bit_set<uint64_t>(path);
+        BOOST_CHECK(m.get().to_vector() == expected);
+
+        {
+                // destruction without close() still writes the pending blocks
+                auto writer = bit_set_writer<uint64_t>(path, N);
+                writer.insert(N - 2);
+        }
+        BOOST_CHECK(mapped_bit_set<uint64_t>(path)->to_vector() == std::vector<int>{ N - 2 });
+#endif
+        std::filesystem::remove(path);
+}
+
+#if XSTD_BIT_SET_FILE_MMAP
+
+BOOST_AUTO_TEST_CASE(Errors)
+{
+        auto const path = temp_path("errors");
+        std::filesystem::remove(path);
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint64_t>(path)), std::system_error);
+
+        save(path, bit_set<100, uint32_t>{ 1, 2, 99 });
+        BOOST_CHECK_NO_THROW(static_cast<void>(mapped_bit_set<uint32_t>(path)));
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint64_t>(path)), std::runtime_error);
+
+        std::filesystem::resize_file(path, 64 + 3 * sizeof(uint32_t));
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint32_t>(path)), std::runtime_error);
+
+        // a value beyond max_size() in the unused bits of the first block
+        save(path, bit_set<100, uint32_t>());
+        {
+                auto file = std::fstream(path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+                file.seekp(64);
+                auto const bad = uint32_t(1);
+                file.write(reinterpret_cast<char const*>(&bad), sizeof(bad));
+        }
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint32_t>(path)), std::runtime_error);
+
+        std::filesystem::resize_file(path, 32);
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint32_t>(path)), std::runtime_error);
+        std::filesystem::resize_file(path, 0);
+        std::filesystem::resize_file(path, 4096);
+        BOOST_CHECK_THROW(static_cast<void>(mapped_bit_set<uint32_t>(path)), std::runtime_error);
+        std::filesystem::remove(path);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
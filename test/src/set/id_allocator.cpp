@@ -0,0 +1,134 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set
+#include <xstd/id_allocator.hpp>         // id_allocator
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_TEST_MESSAGE
+#include <algorithm>                     // max, sort
+#include <atomic>                        // atomic
+#include <chrono>                        // duration, steady_clock
+#include <cstddef>                       // ptrdiff_t, size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <span>                          // span
+#include <thread>                        // hardware_concurrency, thread
+#include <vector>                        // vector
+
+// An id_allocator must hand out every ID exactly once until it is released, also under contention.
+
+BOOST_AUTO_TEST_SUITE(IdAllocator)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+template<class T>
+using allocator_type = id_allocator<T::max_size(), typename T::block_type>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Sequential, T, int_set_types)
+{
+        constexpr auto N = static_cast<int>(T::max_size());
+        allocator_type<T> a;
+        T expected;
+        for (auto i = 0; i < N; ++i) {
+                auto const x = a.allocate();
+                BOOST_CHECK(x && 0 <= *x && *x < N && !expected.contains(*x));
+                expected.add(*x);
+                BOOST_CHECK(a.contains(*x));
+        }
+        BOOST_CHECK(!a.allocate());
+        BOOST_CHECK(a.snapshot() == expected);
+
+        // released IDs are the only ones that can be allocated again
+        std::vector<int> released;
+        for (auto x = 0; x < N; x += 3) {
+                released.push_back(x);
+        }
+        a.release(released);
+        for (auto x : released) {
+                BOOST_CHECK(!a.contains(x));
+        }
+        std::vector<int> again(released.size() + 1);
+        BOOST_CHECK_EQUAL(a.allocate(again), released.size());
+        again.pop_back();
+        std::ranges::sort(again);
+        BOOST_CHECK(again == released);
+        BOOST_CHECK(a.snapshot().full());
+
+        for (auto x = 0; x < N; ++x) {
+                a.release(x);
+        }
+        BOOST_CHECK(a.snapshot().empty());
+        std::vector<int> all(static_cast<std::size_t>(N));
+        BOOST_CHECK_EQUAL(a.allocate(all), all.size());
+        std::ranges::sort(all);
+        BOOST_CHECK(T(all.begin(), all.end()).full());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Contention, T, int_set_types)
+{
+        // each thread repeatedly allocates a few IDs and releases them again, while the owner
+        // counts detect an ID that is handed out twice
+        constexpr auto N = static_cast<int>(T::max_size());
+        constexpr auto num_rounds = 20'000;
+        auto const num_threads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+        allocator_type<T> a;
+        std::vector<std::atomic<int>> owners(static_cast<std::size_t>(N));
+        std::atomic<int> num_duplicates = 0;
+        std::atomic<long> num_allocated = 0;
+        auto const start = std::chrono::steady_clock::now();
+        {
+                std::vector<std::thread> threads;
+                for (auto t = 0; t < num_threads; ++t) {
+                        threads.emplace_back([&, t] {
+                                std::vector<int> ids(static_cast<std::size_t>(1 + t % 4));
+                                auto count = 0L;
+                                for (auto round = 0; round < num_rounds; ++round) {
+                                        auto n = std::size_t(0);
+                                        if (ids.size() == 1) {
+                                                if (auto const x = a.allocate()) {
+                                                        ids[n++] = *x;
+                                                }
+                                        } else {
+                                                n = a.allocate(ids);
+                                        }
+                                        for (auto i = std::size_t(0); i < n; ++i) {
+                                                num_duplicates += owners[static_cast<std::size_t>(ids[i])].fetch_add(1) != 0;
+                                        }
+                                        for (auto i = std::size_t(0); i < n; ++i) {
+                                                owners[static_cast<std::size_t>(ids[i])].fetch_sub(1);
+                                        }
+                                        std::ranges::sort(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(n));
+                                        a.release(std::span<int const>(ids.data(), n));
+                                        count += static_cast<long>(n);
+                                }
+                                num_allocated += count;
+                        });
+                }
+                for (auto& thread : threads) {
+                        thread.join();
+                }
+        }
+        auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        BOOST_CHECK_EQUAL(num_duplicates.load(), 0);
+        BOOST_CHECK(num_allocated.load() > 0);
+        BOOST_CHECK(a.snapshot().empty());
+        BOOST_TEST_MESSAGE(
+                "id_allocator<" << N << ">: " << num_threads << " threads, " <<
+                static_cast<double>(num_allocated.load()) / seconds / 1e6 << " million allocate/release pairs per second"
+        );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
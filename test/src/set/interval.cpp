@@ -0,0 +1,142 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_set.hpp>              // bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // next
+#include <ranges>                        // istream
+#include <sstream>                       // stringstream
+#include <vector>                        // vector
+
+// The interval and bulk operations are checked against the element-wise operations
+// for all intervals [first, last) of sets spanning one, two and several blocks.
+
+BOOST_AUTO_TEST_SUITE(Interval)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<  0, uint8_t>
+,       bit_set<  1, uint8_t>
+,       bit_set<  8, uint8_t>
+,       bit_set< 13, uint8_t>
+,       bit_set< 16, uint8_t>
+,       bit_set< 41, uint8_t>
+,       bit_set< 70, uint16_t>
+,       bit_set<100, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set< 64, uint64_t>
+,       bit_set<200, uint64_t>
+#endif
+>;
+
+template<class T>
+auto pattern()
+{
+        T bs;
+        for (auto i = 0; i < static_cast<int>(bs.max_size()); ++i) {
+                if (i % 3 == 0 || i % 7 == 1) {
+                        bs.add(i);
+                }
+        }
+        return bs;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Intervals, T, int_set_types)
+{
+        auto const N = static_cast<int>(T::max_size());
+        auto const a = pattern<T>();
+        for (auto first = 0; first <= N; ++first) {
+                for (auto last = first; last <= N; ++last) {
+                        auto ins = a;
+                        ins.insert(first, last);
+                        auto era = a;
+                        era.erase(first, last);
+                        auto n = std::size_t(0);
+                        for (auto i = 0; i < N; ++i) {
+                                auto const in = first <= i && i < last;
+                                BOOST_CHECK_EQUAL(ins.contains(i), in || a.contains(i));
+                                BOOST_CHECK_EQUAL(era.contains(i), !in && a.contains(i));
+                                n += in && a.contains(i);
+                        }
+                        BOOST_CHECK_EQUAL(a.count(first, last), n);
+                        BOOST_CHECK_EQUAL(a.contains_any(first, last), n > 0);
+                        BOOST_CHECK_EQUAL(a.contains_all(first, last), n == static_cast<std::size_t>(last - first));
+                        BOOST_CHECK(ins.contains_all(first, last));
+                        BOOST_CHECK(!era.contains_any(first, last));
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(IteratorRangeErase, T, int_set_types)
+{
+        auto const a = pattern<T>();
+        auto const N = static_cast<int>(a.size());
+        for (auto i = 0; i <= N; ++i) {
+                for (auto j = i; j <= N; ++j) {
+                        auto b = a;
+                        auto const first = std::next(b.begin(), i);
+                        auto const last = std::next(b.begin(), j);
+                        auto const expected = static_cast<std::size_t>(N - (j - i));
+                        BOOST_CHECK(b.erase(first, last) == last);
+                        BOOST_CHECK_EQUAL(b.size(), expected);
+                        BOOST_CHECK(b.is_subset_of(a));
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BulkInsert, T, int_set_types)
+{
+        auto const a = pattern<T>();
+        auto const ascending = a.to_vector();
+        auto const descending = std::vector(ascending.rbegin(), ascending.rend());
+        auto interleaved = std::vector<int>();
+        for (auto x : ascending) {
+                interleaved.push_back(x);
+                interleaved.push_back(ascending.front());
+                interleaved.push_back(x);
+        }
+        for (auto const& v : { ascending, descending, interleaved }) {
+                BOOST_CHECK(T(v.begin(), v.end()) == a);
+                T b;
+                b.insert_range(v);
+                BOOST_CHECK(b == a);
+                b.insert(v.begin(), v.end());
+                BOOST_CHECK(b == a);
+        }
+
+        // single-pass input ranges are consumed exactly once
+        auto in = std::stringstream();
+        for (auto x : interleaved) {
+                in << x << ' ';
+        }
+        T c;
+        c.insert_range(std::views::istream<int>(in));
+        BOOST_CHECK(c == a);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Constexpr, T, int_set_types)
+{
+        constexpr auto N = static_cast<int>(T::max_size());
+        constexpr auto b = [] {
+                T bs;
+                bs.insert(N / 4, N / 2);
+                return bs;
+        }();
+        static_assert(b.size() == static_cast<std::size_t>(N / 2 - N / 4));
+        static_assert(b.count(0, N) == b.size());
+        static_assert(b.contains_all(N / 4, N / 2));
+        static_assert(!b.contains_any(0, N / 4) && !b.contains_any(N / 2, N));
+        static_assert([] {
+                auto bs = ~T();
+                bs.erase(0, N);
+                return bs.empty();
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
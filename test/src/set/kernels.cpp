@@ -0,0 +1,276 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // all_isa, random_set
+#include <xstd/bit_set.hpp>              // bit_set, difference_size, intersection_size, jaccard_index, lazy, symmetric_difference_size, union_size
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS, BOOST_CHECK_THROW
+#include <algorithm>                     // lower_bound, upper_bound
+#include <cstddef>                       // byte, size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // next, prev
+#include <random>                        // mt19937
+#include <stdexcept>                     // invalid_argument, out_of_range
+#include <string>                        // string
+#include <vector>                        // vector
+
+// NOTE: the exhaustive tests only cover sets of up to a few blocks.
+// These tests cover the vectorized multi-block kernels against a bit-by-bit reference,
+// for every instruction set that the host supports.
+
+BOOST_AUTO_TEST_SUITE(Kernels)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<  200, uint8_t>
+,       bit_set< 1000, uint16_t>
+,       bit_set< 1024, uint32_t>
+,       bit_set< 4095, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set< 4096, uint64_t>
+,       bit_set<16383, uint64_t>
+#endif
+#if defined(__GNUG__)
+,       bit_set< 2000, __uint128_t>
+#endif
+>;
+
+template<class T>
+auto all_random_set_pairs(auto fun)
+{
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.001, 0.1, 0.5, 0.9, 1.0 }) {
+                for (auto rep = 0; rep < 4; ++rep) {
+                        auto const a = random_set<T>(gen, density);
+                        auto const b = random_set<T>(gen, 1.0 - density / 2);
+                        fun(a, b);
+                        fun(b, a);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(CompoundAssignment, T, int_set_types)
+{
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const& b) {
+                        auto const N = static_cast<int>(T::max_size());
+                        auto c_and = a; c_and &= b;
+                        auto c_or  = a; c_or  |= b;
+                        auto c_xor = a; c_xor ^= b;
+                        auto c_sub = a; c_sub -= b;
+                        for (auto i = 0; i < N; ++i) {
+                                BOOST_CHECK_EQUAL(c_and.contains(i), a.contains(i) && b.contains(i));
+                                BOOST_CHECK_EQUAL(c_or .contains(i), a.contains(i) || b.contains(i));
+                                BOOST_CHECK_EQUAL(c_xor.contains(i), a.contains(i) != b.contains(i));
+                                BOOST_CHECK_EQUAL(c_sub.contains(i), a.contains(i) && !b.contains(i));
+                        }
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Size, T, int_set_types)
+{
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const&) {
+                        auto const N = static_cast<int>(T::max_size());
+                        auto n = 0;
+                        for (auto i = 0; i < N; ++i) {
+                                n += a.contains(i);
+                        }
+                        BOOST_CHECK_EQUAL(a.ssize(), n);
+                        BOOST_CHECK_EQUAL(a.size(), static_cast<std::size_t>(n));
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Counting, T, int_set_types)
+{
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const& b) {
+                        BOOST_CHECK_EQUAL(intersection_size(a, b), (a & b).size());
+                        BOOST_CHECK_EQUAL(union_size(a, b), (a | b).size());
+                        BOOST_CHECK_EQUAL(difference_size(a, b), (a - b).size());
+                        BOOST_CHECK_EQUAL(symmetric_difference_size(a, b), (a ^ b).size());
+                        auto const u = (a | b).size();
+                        BOOST_CHECK_EQUAL(jaccard_index(a, b), u ? static_cast<double>((a & b).size()) / static_cast<double>(u) : 1.0);
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Shift, T, int_set_types)
+{
+        auto gen = std::mt19937(42);
+        auto const a = random_set<T>(gen, 0.5);
+        auto const elements = a.to_vector();
+        auto const N = static_cast<int>(T::max_size());
+        for (auto n = 0; n < N; ++n) {
+                T shl, shr;
+                for (auto x : elements) {
+                        if (x + n < N) {
+                                shl.add(x + n);
+                        }
+                        if (x - n >= 0) {
+                                shr.add(x - n);
+                        }
+                }
+                all_isa([&] {
+                        BOOST_CHECK((a << n) == shl);
+                        BOOST_CHECK((a >> n) == shr);
+                });
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Navigation, T, int_set_types)
+{
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const&) {
+                        auto const N = static_cast<int>(T::max_size());
+                        std::vector<int> v;
+                        for (auto i = 0; i < N; ++i) {
+                                if (a.contains(i)) {
+                                        v.push_back(i);
+                                }
+                        }
+                        BOOST_CHECK_EQUAL_COLLECTIONS(a.begin(), a.end(), v.begin(), v.end());
+                        auto const decoded = a.to_vector();
+                        BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(), v.begin(), v.end());
+                        std::vector<int> visited;
+                        a.for_each([&](auto x) { visited.push_back(x); });
+                        BOOST_CHECK_EQUAL_COLLECTIONS(visited.begin(), visited.end(), v.begin(), v.end());
+                        auto const lazy_a = lazy(a);
+                        BOOST_CHECK_EQUAL_COLLECTIONS(lazy_a.begin(), lazy_a.end(), v.begin(), v.end());
+                        BOOST_CHECK_EQUAL_COLLECTIONS(a.rbegin(), a.rend(), v.rbegin(), v.rend());
+                        if (!v.empty()) {
+                                BOOST_CHECK_EQUAL(a.front(), v.front());
+                                BOOST_CHECK_EQUAL(a.back(), v.back());
+                        }
+                        auto const value = [&](auto const& s, auto it) {
+                                return it == s.end() ? N : *it;
+                        };
+                        for (auto i = 0; i < N; i += 7) {
+                                BOOST_CHECK_EQUAL(value(a, a.lower_bound(i)), value(v, std::ranges::lower_bound(v, i)));
+                                BOOST_CHECK_EQUAL(value(a, a.upper_bound(i)), value(v, std::ranges::upper_bound(v, i)));
+                        }
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Bytes, T, int_set_types)
+{
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const&) {
+                        std::vector<std::byte> expected(T::num_bytes());
+                        for (auto x : a) {
+                                expected[static_cast<std::size_t>(x / 8)] |= std::byte(0x80 >> (x % 8));
+                        }
+                        auto const bytes = a.to_bytes();
+                        BOOST_CHECK(bytes == expected);
+                        T b;
+                        b.from_bytes(bytes);
+                        BOOST_CHECK(b == a);
+
+                        // the representation does not depend on the block type or the container
+                        auto const c = bit_set<T::max_size(), uint8_t>(a.begin(), a.end());
+                        BOOST_CHECK(c.to_bytes() == expected);
+                        auto d = dynamic_bit_set<typename T::block_type>(T::max_size());
+                        d.from_bytes(bytes);
+                        BOOST_CHECK(d.to_vector() == a.to_vector());
+                        BOOST_CHECK(d.to_bytes() == expected);
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Strings, T, int_set_types)
+{
+        constexpr auto N = T::max_size();
+        all_isa([] {
+                all_random_set_pairs<T>([](auto const& a, auto const& b) {
+                        std::string expected(N, '0');
+                        for (auto x : a) {
+                                expected[N - 1 - static_cast<std::size_t>(x)] = '1';
+                        }
+                        auto const str = a.to_string();
+                        BOOST_CHECK(str == expected);
+                        auto c = b;
+                        c.from_string(str);
+                        BOOST_CHECK(c == a);
+                        c.from_string(str + str);
+                        BOOST_CHECK(c == a);
+
+                        // a substring of M characters holds the elements below M
+                        for (auto M : { std::size_t(0), std::size_t(1), N / 3, N - 1 }) {
+                                T prefix;
+                                for (auto x : a) {
+                                        if (static_cast<std::size_t>(x) < M) {
+                                                prefix.add(x);
+                                        }
+                                }
+                                c.from_string("ab" + str + "cd", 2 + N - M, M);
+                                BOOST_CHECK(c == prefix);
+                        }
+
+                        auto const dots = a.to_string('.', 'x');
+                        BOOST_CHECK(dots.find('0') == std::string::npos && dots.find('1') == std::string::npos);
+                        c = b;
+                        c.from_string(dots.c_str(), std::string::npos, '.', 'x');
+                        BOOST_CHECK(c == a);
+                        c = b;
+                        c.from_string(a.template to_string<wchar_t>());
+                        BOOST_CHECK(c == a);
+                });
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(StringErrors, T, int_set_types)
+{
+        constexpr auto N = T::max_size();
+        all_isa([] {
+                auto const str = (~T()).to_string();
+                auto c = T();
+                BOOST_CHECK_THROW(c.from_string(str, N + 1), std::out_of_range);
+                for (auto i : { std::size_t(0), std::size_t(31), std::size_t(64), N / 2, N - 1, N, N + 70 }) {
+                        auto bad = str + str;
+                        bad[i] = '2';
+                        c = ~T();
+                        BOOST_CHECK_THROW(c.from_string(bad), std::invalid_argument);
+                        BOOST_CHECK(c.empty());
+                }
+                c.from_string(str, N);
+                BOOST_CHECK(c.empty());
+        });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Constexpr, T, int_set_types)
+{
+        constexpr auto N = T::max_size();
+        constexpr auto a = T({ 0, 1, 63, 64, 199 });
+        constexpr auto b = ~T();
+        static_assert((a & b) == a);
+        static_assert((a | b) == b);
+        static_assert((a ^ b) == ~a);
+        static_assert((b - a) == ~a);
+        static_assert(a.size() == 5);
+        static_assert(b.size() == b.max_size());
+        static_assert(a.front() == 0 && a.back() == 199);
+        static_assert(*std::next(a.begin(), 3) == 64 && *std::prev(a.end(), 3) == 63);
+        static_assert(a.to_vector() == std::vector{ 0, 1, 63, 64, 199 });
+        static_assert(a.for_each([sum = 0](auto x) mutable { return sum += x; })(0) == 327);
+        static_assert(a.to_bytes()[0] == std::byte(0b1100'0000) && a.to_bytes()[24] == std::byte(0b0000'0001));
+        static_assert([] {
+                auto c = T();
+                c.from_bytes(T({ 0, 1, 63, 64, 199 }).to_bytes());
+                return c == T({ 0, 1, 63, 64, 199 });
+        }());
+        static_assert(a.to_string().substr(N - 200) == std::string(1, '1') + std::string(134, '0') + "11" + std::string(61, '0') + "11");
+        static_assert([] {
+                auto c = T();
+                c.from_string(T({ 0, 1, 63, 64, 199 }).to_string());
+                return c == T({ 0, 1, 63, 64, 199 });
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
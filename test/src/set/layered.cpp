@@ -0,0 +1,148 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set
+#include <xstd/layered_bit_set.hpp>      // layered_bit_set
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // bidirectional_iterator, prev
+#include <random>                        // bernoulli_distribution, mt19937, uniform_int_distribution
+#include <ranges>                        // bidirectional_range
+
+// A layered_bit_set must behave as the bit_set it wraps, with one to four summary layers.
+
+BOOST_AUTO_TEST_SUITE(Layered)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    1, uint8_t>
+,       bit_set<    8, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set< 4097, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4096, uint64_t>
+,       bit_set< 5000, uint64_t>
+#endif
+>;
+
+template<class T>
+using layered_type = layered_bit_set<T::max_size(), typename T::block_type>;
+
+template<class T>
+auto check_equal(layered_type<T> const& ls, T const& bs)
+{
+        auto const N = static_cast<int>(T::max_size());
+        BOOST_CHECK(ls.bits() == bs);
+        BOOST_CHECK_EQUAL(ls.empty(), bs.empty());
+        BOOST_CHECK_EQUAL_COLLECTIONS(ls.begin(), ls.end(), bs.begin(), bs.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(ls.rbegin(), ls.rend(), bs.rbegin(), bs.rend());
+        if (!bs.empty()) {
+                BOOST_CHECK_EQUAL(ls.front(), bs.front());
+                BOOST_CHECK_EQUAL(ls.back(), bs.back());
+        }
+        auto const value = [=](auto const& s, auto it) {
+                return it == s.end() ? N : static_cast<int>(*it);
+        };
+        for (auto i = 0; i < N; ++i) {
+                BOOST_CHECK_EQUAL(value(ls, ls.lower_bound(i)), value(bs, bs.lower_bound(i)));
+                BOOST_CHECK_EQUAL(value(ls, ls.upper_bound(i)), value(bs, bs.upper_bound(i)));
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Interface, T, int_set_types)
+{
+        using L = layered_type<T>;
+        static_assert(std::bidirectional_iterator<typename L::iterator>);
+        static_assert(std::ranges::bidirectional_range<L>);
+
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.001, 0.01, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.01);
+                auto const la = L(a);
+                auto const lb = L(b.begin(), b.end());
+                check_equal(la, a);
+                check_equal(lb, b);
+                check_equal(~la, ~a);
+                check_equal(la & lb, a & b);
+                check_equal(la | lb, a | b);
+                check_equal(la ^ lb, a ^ b);
+                check_equal(la - lb, a - b);
+                BOOST_CHECK_EQUAL(la == lb, a == b);
+                BOOST_CHECK((la <=> lb) == (a <=> b));
+                BOOST_CHECK_EQUAL(la.is_subset_of(lb), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(la.intersects(lb), a.intersects(b));
+                BOOST_CHECK(la.to_vector() == a.to_vector());
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Incremental, T, int_set_types)
+{
+        constexpr auto N = static_cast<int>(T::max_size());
+        if constexpr (N > 0) {
+                auto gen = std::mt19937(42);
+                auto element = std::uniform_int_distribution<int>(0, N - 1);
+                auto coin = std::bernoulli_distribution(0.5);
+                T bs;
+                layered_type<T> ls;
+                for (auto i = 0; i < 4 * N; ++i) {
+                        auto const x = element(gen);
+                        if (coin(gen)) {
+                                BOOST_CHECK_EQUAL(ls.insert(x).second, bs.insert(x).second);
+                        } else {
+                                BOOST_CHECK_EQUAL(ls.erase(x), bs.erase(x));
+                        }
+                        BOOST_CHECK_EQUAL(ls.empty(), bs.empty());
+                        if (!bs.empty()) {
+                                BOOST_CHECK_EQUAL(ls.front(), bs.front());
+                                BOOST_CHECK_EQUAL(ls.back(), bs.back());
+                        }
+                }
+                check_equal(ls, bs);
+                ls.erase(ls.begin(), ls.end());
+                BOOST_CHECK(ls.empty() && ls.begin() == ls.end());
+                ls.fill();
+                check_equal(ls, ~T());
+                ls.clear();
+                check_equal(ls, T());
+        }
+}
+
+BOOST_AUTO_TEST_CASE(Sparse)
+{
+        constexpr auto N = 1 << 24;
+        layered_bit_set<N, uint64_t> ls;
+        BOOST_CHECK(ls.empty());
+        ls.insert({ 3, N / 2, N - 1 });
+        BOOST_CHECK_EQUAL(*ls.lower_bound(4), N / 2);
+        BOOST_CHECK_EQUAL(*ls.upper_bound(N / 2), N - 1);
+        BOOST_CHECK_EQUAL(*std::prev(ls.lower_bound(N / 2)), 3);
+        BOOST_CHECK_EQUAL(ls.back(), N - 1);
+        ls.pop(N - 1);
+        BOOST_CHECK(ls.upper_bound(N / 2) == ls.end());
+        BOOST_CHECK_EQUAL(ls.back(), N / 2);
+        ls.pop(3);
+        ls.pop(N / 2);
+        BOOST_CHECK(ls.empty());
+}
+
+BOOST_AUTO_TEST_CASE(Constexpr)
+{
+        static_assert([] {
+                auto ls = layered_bit_set<5000, uint8_t>{ 1, 700, 4999 };
+                ls.pop(700);
+                return ls.size() == 2 && *ls.lower_bound(2) == 4999 && *std::prev(ls.end(), 2) == 1 && !ls.empty();
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <xstd/bit_matrix.hpp>           // bit_matrix
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <memory>                        // make_unique
+#include <random>                        // bernoulli_distribution, mt19937
+
+// The matrix operations must agree with a bit-by-bit reference over the rows.
+
+BOOST_AUTO_TEST_SUITE(Matrix)
+
+using namespace xstd;
+
+using bit_matrix_types = boost::mpl::vector
+<       bit_matrix<  0,   5, uint8_t>
+,       bit_matrix<  5,   0, uint8_t>
+,       bit_matrix<  1,   1, uint8_t>
+,       bit_matrix< 13,  29, uint8_t>
+,       bit_matrix< 70,  33, uint16_t>
+,       bit_matrix< 32,  32, uint32_t>
+,       bit_matrix<100, 250, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_matrix< 64,  64, uint64_t>
+,       bit_matrix<130, 200, uint64_t>
+,       bit_matrix<300,  65, uint64_t>
+#endif
+#if defined(__GNUG__)
+,       bit_matrix<150, 140, __uint128_t>
+#endif
+>;
+
+template<class T>
+auto random_matrix(std::mt19937& gen, double density)
+{
+        auto coin = std::bernoulli_distribution(density);
+        auto nrv = std::make_unique<T>();
+        for (auto i = 0; i < static_cast<int>(T::num_rows()); ++i) {
+                for (auto j = 0; j < static_cast<int>(T::num_columns()); ++j) {
+                        if (coin(gen)) {
+                                nrv->add(i, j);
+                        }
+                }
+        }
+        return nrv;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Transpose, T, bit_matrix_types)
+{
+        constexpr auto R = static_cast<int>(T::num_rows());
+        constexpr auto C = static_cast<int>(T::num_columns());
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.1, 0.5, 1.0 }) {
+                auto const m = random_matrix<T>(gen, density);
+                auto const t = std::make_unique<typename T::transpose_type>(m->transpose());
+                auto const sizes = m->column_sizes();
+                for (auto j = 0; j < C; ++j) {
+                        auto const col = m->column(j);
+                        BOOST_CHECK(t->row(j) == col);
+                        BOOST_CHECK_EQUAL(sizes[static_cast<std::size_t>(j)], col.size());
+                        for (auto i = 0; i < R; ++i) {
+                                BOOST_CHECK_EQUAL(t->contains(j, i), m->contains(i, j));
+                        }
+                }
+                BOOST_CHECK(t->transpose() == *m);
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Reductions, T, bit_matrix_types)
+{
+        constexpr auto R = static_cast<int>(T::num_rows());
+        constexpr auto C = static_cast<int>(T::num_columns());
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.01, 0.5, 0.99, 1.0 }) {
+                auto const m = random_matrix<T>(gen, density);
+                auto const any = m->reduce_or();
+                auto const all = m->reduce_and();
+                for (auto j = 0; j < C; ++j) {
+                        auto const n = m->column(j).size();
+                        BOOST_CHECK_EQUAL(any.contains(j), n > 0);
+                        BOOST_CHECK_EQUAL(all.contains(j), n == static_cast<std::size_t>(R));
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(Access)
+{
+        auto m = bit_matrix<3, 70>();
+        m.add(0, 69);
+        m[2].add(1);
+        m.row(1).insert({ 0, 64 });
+        BOOST_CHECK(m.contains(0, 69));
+        BOOST_CHECK(m.column(1) == (bit_set<3>{ 2 }));
+        BOOST_CHECK(m.column(64) == (bit_set<3>{ 1 }));
+        BOOST_CHECK_EQUAL(m.rows().size(), 3);
+        BOOST_CHECK(m.rows()[1] == (bit_set<70>{ 0, 64 }));
+        m.pop(0, 69);
+        BOOST_CHECK(m[0].empty());
+        m.clear();
+        BOOST_CHECK(m == (bit_matrix<3, 70>()));
+
+        constexpr auto c = [] {
+                auto nrv = bit_matrix<70, 3>();
+                nrv.add(69, 2);
+                return nrv.transpose();
+        }();
+        static_assert(c.contains(2, 69));
+        static_assert(c.column_sizes()[69] == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,8 +26,11 @@ using int_set_types = boost::mpl::vector
 ,       bit_set<17, uint8_t>
 ,       bit_set<17, uint16_t>
 ,       bit_set<17, uint32_t>
+,       bit_set<48, uint8_t>
+,       bit_set<48, uint16_t>
 #if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
 ,       bit_set<17, uint64_t>
+,       bit_set<48, uint64_t>
 #endif
 #if defined(__GNUG__)
 ,       bit_set<17, __uint128_t>
@@ -0,0 +1,209 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set, external_storage, intersection_size, jaccard_index, union_size
+#include <xstd/bit_span.hpp>             // bit_span
+#include <xstd/dynamic_bit_set.hpp>      // dynamic_bit_set, intersection_size, jaccard_index, union_size
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <algorithm>                     // all_of, copy
+#include <array>                         // array
+#include <concepts>                      // same_as
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <iterator>                      // bidirectional_iterator
+#include <random>                        // mt19937
+#include <ranges>                        // bidirectional_range
+#include <span>                          // dynamic_extent
+#include <type_traits>                   // is_copy_constructible_v, is_default_constructible_v
+#include <vector>                        // vector
+
+// A bit_span over a buffer must behave as the bit_set of the same max_size and block type, and
+// the fixed and dynamic extents must agree on the contents of the buffer.
+
+BOOST_AUTO_TEST_SUITE(Span)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<   16, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+template<class T>
+using fixed_type = bit_span<T::max_size(), typename T::block_type>;
+
+template<class T>
+using dynamic_type = bit_span<std::dynamic_extent, typename T::block_type>;
+
+template<class S, class T>
+auto check_equal(S const& s, T const& bs)
+{
+        auto const N = static_cast<int>(T::max_size());
+        BOOST_CHECK_EQUAL(s.max_size(), T::max_size());
+        BOOST_CHECK_EQUAL(s.size(), bs.size());
+        BOOST_CHECK_EQUAL(s.empty(), bs.empty());
+        BOOST_CHECK_EQUAL(s.full(), bs.full());
+        BOOST_CHECK_EQUAL_COLLECTIONS(s.begin(), s.end(), bs.begin(), bs.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(s.rbegin(), s.rend(), bs.rbegin(), bs.rend());
+        auto const value = [=](auto const& set, auto it) {
+                return it == set.end() ? N : static_cast<int>(*it);
+        };
+        for (auto i = 0; i < N; ++i) {
+                BOOST_CHECK_EQUAL(s.contains(i), bs.contains(i));
+                BOOST_CHECK_EQUAL(value(s, s.lower_bound(i)), value(bs, bs.lower_bound(i)));
+                BOOST_CHECK_EQUAL(value(s, s.upper_bound(i)), value(bs, bs.upper_bound(i)));
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Interface, T, int_set_types)
+{
+        using F = fixed_type<T>;
+        using D = dynamic_type<T>;
+        using block = typename T::block_type;
+        static_assert(std::same_as<F, bit_set<T::max_size(), block, external_storage>>);
+        static_assert(!std::is_default_constructible_v<D>);
+        static_assert(!std::is_copy_constructible_v<D>);
+        static_assert(std::bidirectional_iterator<typename D::iterator>);
+        static_assert(std::ranges::bidirectional_range<D>);
+        if constexpr (T::max_size() > 0) {
+                BOOST_CHECK_EQUAL(D::num_blocks(T::max_size()), F::num_blocks());
+                BOOST_CHECK_EQUAL(D::num_blocks(static_cast<int>(T::max_size())), F::num_blocks());
+        }
+
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.5);
+                std::vector<block> buf_a(F::num_blocks()), buf_b(F::num_blocks());
+                auto fa = F(std::span<block, F::num_blocks()>(buf_a));
+                auto fb = F(std::span<block, F::num_blocks()>(buf_b));
+                fa.insert(a.begin(), a.end());
+                fb.insert(b.begin(), b.end());
+
+                // the dynamic extent sees the blocks written through the fixed extent
+                auto da = D(T::max_size(), buf_a);
+                auto const db = D(T::max_size(), buf_b);
+                check_equal(fa, a);
+                check_equal(da, a);
+                check_equal(db, b);
+                BOOST_CHECK_EQUAL(da == db, a == b);
+                BOOST_CHECK((da <=> db) == (a <=> b));
+                BOOST_CHECK_EQUAL(da.is_subset_of(db), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(da.intersects(db), a.intersects(b));
+                BOOST_CHECK_EQUAL(intersection_size(da, db), intersection_size(a, b));
+
+                auto const saved = buf_a;
+                auto const check_op = [&](auto op, T const& expected) {
+                        std::ranges::copy(saved, buf_a.begin());
+                        op(da);
+                        check_equal(da, expected);
+                        check_equal(fa, expected);
+                };
+                check_op([](auto& s) { s.complement(); }, ~a);
+                check_op([&](auto& s) { s &= db; }, a & b);
+                check_op([&](auto& s) { s |= db; }, a | b);
+                check_op([&](auto& s) { s ^= db; }, a ^ b);
+                check_op([&](auto& s) { s -= db; }, a - b);
+                if constexpr (T::max_size() > 3) {
+                        check_op([](auto& s) { s <<= 3; }, a << 3);
+                        check_op([](auto& s) { s >>= 3; }, a >> 3);
+                }
+
+                da = db;
+                BOOST_CHECK(buf_a == buf_b);
+                check_equal(fa, b);
+                da.clear();
+                BOOST_CHECK(std::ranges::all_of(buf_a, [](auto x) { return x == 0; }));
+                auto dc = D(T::max_size(), buf_b);
+                swap(da, dc);
+                check_equal(fa, b);
+                check_equal(fb, T());
+
+                // distinct views over the same buffer leave it unchanged on assignment and swap
+                auto dd = D(T::max_size(), buf_a);
+                da = dd;
+                check_equal(fa, b);
+                swap(da, dd);
+                check_equal(fa, b);
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Mixed, T, int_set_types)
+{
+        using F = fixed_type<T>;
+        using D = dynamic_type<T>;
+        using block = typename T::block_type;
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.5);
+                auto const v = a.to_vector();
+                auto const da = dynamic_bit_set<block>(T::max_size(), v.begin(), v.end());
+                std::vector<block> buf(F::num_blocks());
+                auto f = F(std::span<block, F::num_blocks()>(buf));
+                auto d = D(T::max_size(), buf);
+                f.insert(b.begin(), b.end());
+
+                // views compare, count and combine with owning sets of either extent
+                BOOST_CHECK(f == b);
+                BOOST_CHECK_EQUAL(a == f, a == b);
+                BOOST_CHECK((a <=> f) == (a <=> b));
+                BOOST_CHECK((d <=> da) == (b <=> a));
+                BOOST_CHECK_EQUAL(da == d, a == b);
+                BOOST_CHECK_EQUAL(a.is_subset_of(f), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(da.is_proper_subset_of(d), a.is_proper_subset_of(b));
+                BOOST_CHECK_EQUAL(d.intersects(da), b.intersects(a));
+                BOOST_CHECK_EQUAL(intersection_size(f, a), intersection_size(b, a));
+                BOOST_CHECK_EQUAL(union_size(da, d), union_size(a, b));
+                BOOST_CHECK_EQUAL(jaccard_index(d, da), jaccard_index(b, a));
+
+                auto c = a;
+                c &= f;
+                check_equal(c, a & b);
+                auto dc = da;
+                dc -= d;
+                check_equal(dc, a - b);
+                f |= a;
+                check_equal(d, a | b);
+                d ^= da;
+                check_equal(f, (a | b) ^ a);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(Prefix)
+{
+        // a dynamic extent only uses the blocks it needs from a larger buffer
+        std::vector<uint64_t> buffer(4, 0);
+        auto s = bit_span<std::dynamic_extent, uint64_t>(100, buffer);
+        s.insert({ 0, 63, 64, 99 });
+        BOOST_CHECK_EQUAL(s.size(), 4u);
+        BOOST_CHECK(buffer[2] == 0);
+        BOOST_CHECK(buffer[3] == 0);
+        BOOST_CHECK(buffer[1] == 0x8000'0000'0000'0001);
+        BOOST_CHECK(buffer[0] == 0x8000'0000'1000'0000);
+}
+
+BOOST_AUTO_TEST_CASE(Constexpr)
+{
+        static_assert([] {
+                std::array<uint8_t, 3> buffer{};
+                auto a = bit_span<std::dynamic_extent, uint8_t>(20, buffer);
+                a.insert({ 2, 3, 5, 7 });
+                a >>= 1;
+                return buffer[2] == 0b0110'1010 && a.size() == 4;
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,206 @@
+//          Copyright Rein Halbersma 2014-2022.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set/random.hpp>                // random_set
+#include <xstd/bit_set.hpp>              // bit_set, difference_size, external_storage, heap_storage, intersection_size, jaccard_index, lazy, symmetric_difference_size, union_size
+#include <boost/mpl/vector.hpp>          // vector
+#include <boost/test/unit_test.hpp>      // BOOST_AUTO_TEST_SUITE, BOOST_AUTO_TEST_SUITE_END, BOOST_AUTO_TEST_CASE, BOOST_AUTO_TEST_CASE_TEMPLATE, BOOST_CHECK, BOOST_CHECK_EQUAL, BOOST_CHECK_EQUAL_COLLECTIONS
+#include <algorithm>                     // all_of
+#include <array>                         // array
+#include <cstdint>                       // uint8_t, uint16_t, uint32_t, uint64_t
+#include <initializer_list>              // initializer_list
+#include <random>                        // mt19937
+#include <type_traits>                   // is_copy_constructible_v, is_default_constructible_v, is_nothrow_constructible_v, is_nothrow_move_constructible_v
+#include <utility>                       // declval, move
+
+// The heap and external storage policies must behave as the default inline storage.
+
+BOOST_AUTO_TEST_SUITE(Storage)
+
+using namespace xstd;
+
+using int_set_types = boost::mpl::vector
+<       bit_set<    0, uint8_t>
+,       bit_set<    1, uint8_t>
+,       bit_set<   13, uint8_t>
+,       bit_set<  200, uint8_t>
+,       bit_set<   70, uint16_t>
+,       bit_set< 1000, uint32_t>
+#if defined(__GNUG__) || defined(_MSC_VER) && defined(WIN64)
+,       bit_set<   64, uint64_t>
+,       bit_set< 4095, uint64_t>
+#endif
+>;
+
+template<class T>
+using heap_type = bit_set<T::max_size(), typename T::block_type, heap_storage>;
+
+template<class T>
+using external_type = bit_set<T::max_size(), typename T::block_type, external_storage>;
+
+template<class S, class T>
+auto check_equal(S const& s, T const& bs)
+{
+        BOOST_CHECK_EQUAL(s.size(), bs.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(s.begin(), s.end(), bs.begin(), bs.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(s.rbegin(), s.rend(), bs.rbegin(), bs.rend());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Heap, T, int_set_types)
+{
+        using H = heap_type<T>;
+        static_assert(sizeof(H) == sizeof(void*));
+        static_assert(std::is_nothrow_move_constructible_v<H>);
+        // constructors that allocate must be able to report bad_alloc
+        static_assert(!std::is_nothrow_constructible_v<H, std::initializer_list<int>>);
+        static_assert(!std::is_nothrow_constructible_v<H, int const*, int const*>);
+        static_assert(std::is_nothrow_constructible_v<T, std::initializer_list<int>>);
+        // so must writes, which allocate again on a moved-from set
+        static_assert(!noexcept(std::declval<H&>().add(0)));
+        static_assert(!noexcept(std::declval<H&>() &= std::declval<H const&>()));
+        static_assert(noexcept(std::declval<T&>().add(0)));
+
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.5);
+                auto const ha = H(a.begin(), a.end());
+                auto const hb = H(b.begin(), b.end());
+                check_equal(ha, a);
+                check_equal(~ha, ~a);
+                check_equal(ha & hb, a & b);
+                check_equal(ha | hb, a | b);
+                check_equal(ha ^ hb, a ^ b);
+                check_equal(ha - hb, a - b);
+                if constexpr (T::max_size() > 3) {
+                        check_equal(ha << 3, a << 3);
+                        check_equal(ha >> 3, a >> 3);
+                }
+                check_equal(H(lazy(ha) & ~hb), a - b);
+                BOOST_CHECK((ha <=> hb) == (a <=> b));
+                BOOST_CHECK_EQUAL(ha == hb, a == b);
+                BOOST_CHECK_EQUAL(ha.is_subset_of(hb), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(intersection_size(ha, hb), intersection_size(a, b));
+
+                auto hc = ha;
+                auto hd = std::move(hc);
+                check_equal(hd, a);
+                hc = hb;
+                check_equal(hc, b);
+                hc = std::move(hd);
+                check_equal(hc, a);
+                check_equal(hd, b);
+                swap(hc, hd);
+                check_equal(hc, b);
+                check_equal(hd, a);
+
+                // a moved-from set reads as empty and can be reused
+                auto const he = std::move(hc);
+                check_equal(he, b);
+                check_equal(hc, T());
+                BOOST_CHECK(hc == H());
+                hc.clear();
+                hc.insert(a.begin(), a.end());
+                check_equal(hc, a);
+                if constexpr (T::max_size() > 0) {
+                        auto const hf = std::move(hc);
+                        check_equal(hf, a);
+                        hc.add(0);
+                        BOOST_CHECK_EQUAL(hc.size(), 1u);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(External, T, int_set_types)
+{
+        using E = external_type<T>;
+        static_assert(!std::is_default_constructible_v<E>);
+        static_assert(!std::is_copy_constructible_v<E>);
+
+        auto gen = std::mt19937(42);
+        auto const a = random_set<T>(gen, 0.5);
+        auto const b = random_set<T>(gen, 0.5);
+        std::array<typename T::block_type, T::num_blocks()> buf_a{}, buf_b{};
+        auto ea = E(buf_a);
+        auto eb = E(buf_b);
+        BOOST_CHECK(ea.empty());
+        ea.insert(a.begin(), a.end());
+        eb.insert(b.begin(), b.end());
+        check_equal(ea, a);
+
+        // the buffer holds the blocks, so a second view over it sees the same set
+        auto const view = E(buf_a);
+        check_equal(view, a);
+
+        ea &= eb;
+        check_equal(view, a & b);
+        ea = eb;
+        check_equal(view, b);
+        BOOST_CHECK(ea == eb);
+        ea.clear();
+        BOOST_CHECK(std::ranges::all_of(buf_a, [](auto block) { return block == 0; }));
+        swap(ea, eb);
+        check_equal(ea, b);
+        BOOST_CHECK(eb.empty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Mixed, T, int_set_types)
+{
+        using H = heap_type<T>;
+        using E = external_type<T>;
+        auto gen = std::mt19937(42);
+        for (auto density : { 0.0, 0.5, 1.0 }) {
+                auto const a = random_set<T>(gen, density);
+                auto const b = random_set<T>(gen, 0.5);
+                auto const h = H(b.begin(), b.end());
+                std::array<typename T::block_type, T::num_blocks()> buf{};
+                auto e = E(buf);
+                e.insert(b.begin(), b.end());
+
+                // sets with different storage compare and count as their contents
+                BOOST_CHECK(h == b);
+                BOOST_CHECK(e == h);
+                BOOST_CHECK_EQUAL(a == h, a == b);
+                BOOST_CHECK((a <=> h) == (a <=> b));
+                BOOST_CHECK((e <=> a) == (b <=> a));
+                BOOST_CHECK_EQUAL(a.is_subset_of(h), a.is_subset_of(b));
+                BOOST_CHECK_EQUAL(h.is_proper_subset_of(a), b.is_proper_subset_of(a));
+                BOOST_CHECK_EQUAL(e.intersects(a), b.intersects(a));
+                BOOST_CHECK_EQUAL(intersection_size(a, e), intersection_size(a, b));
+                BOOST_CHECK_EQUAL(union_size(h, a), union_size(b, a));
+                BOOST_CHECK_EQUAL(difference_size(a, h), difference_size(a, b));
+                BOOST_CHECK_EQUAL(symmetric_difference_size(e, a), symmetric_difference_size(b, a));
+                BOOST_CHECK_EQUAL(jaccard_index(a, h), jaccard_index(a, b));
+
+                // and combine in place
+                auto c = a; c &= h; check_equal(c, a & b);
+                c = a; c |= e; check_equal(c, a | b);
+                c = a; c ^= h; check_equal(c, a ^ b);
+                c = a; c -= e; check_equal(c, a - b);
+                auto d = h; d &= a; check_equal(d, b & a);
+                e -= a;
+                check_equal(e, b - a);
+                e |= h;
+                check_equal(E(buf), b);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(Constexpr)
+{
+        static_assert([] {
+                auto a = bit_set<200, uint8_t, heap_storage>{ 0, 1, 99, 199 };
+                auto b = std::move(a);
+                b <<= 1;
+                return b.size() == 3 && b.back() == 100;
+        }());
+        static_assert([] {
+                std::array<uint8_t, bit_set<20, uint8_t>::num_blocks()> buffer{};
+                auto a = bit_set<20, uint8_t, external_storage>(buffer);
+                a.insert({ 2, 3, 5, 7 });
+                return buffer[2] == 0b0011'0101;
+        }());
+}
+
+BOOST_AUTO_TEST_SUITE_END()